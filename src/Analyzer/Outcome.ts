@@ -22,6 +22,12 @@ namespace Outcome {
       return s.replace(/\\./g, m => m[1]);
     }
 
+    // Strings are indexed by code point, as in the VM, rather than by
+    // UTF-16 unit
+    export function codePoints(s: string) {
+      return [...s];
+    }
+
     export type MethodMap = {
       Length: {
         base: String;
@@ -33,11 +39,31 @@ namespace Outcome {
         name: 'String';
         argLength: 0;
       };
+      Binary: {
+        base: String;
+        name: 'Binary';
+        argLength: 0;
+      };
+      Json: {
+        base: String;
+        name: 'Json';
+        argLength: 0;
+      };
+      ParseJson: {
+        base: String;
+        name: 'ParseJson';
+        argLength: 0;
+      };
       Kind: {
         base: String;
         name: 'Kind';
         argLength: 0;
       };
+      Slice: {
+        base: String;
+        name: 'Slice';
+        argLength: 2;
+      };
     };
 
     export type Method = MethodMap[keyof MethodMap];
@@ -51,10 +77,26 @@ namespace Outcome {
         args: [];
         result: String;
       };
+      Binary: {
+        args: [];
+        result: Unknown;
+      };
+      Json: {
+        args: [];
+        result: Unknown;
+      };
+      ParseJson: {
+        args: [];
+        result: Value | Exception;
+      };
       Kind: {
         args: [];
         result: String;
       };
+      Slice: {
+        args: [Value, Value];
+        result: String | Exception;
+      };
     };
 
     export const methodImpls: {
@@ -63,9 +105,22 @@ namespace Outcome {
         MethodCallMap[name]
       >;
     } = {
-      Length: (base, args) => Number(base.v.length),
+      Length: (base, args) => Number(codePoints(base.v).length),
       String: (base, args) => String('\'' + escape(base.v) + '\''),
+      Binary: EncodingUnknown,
+      Json: EncodingUnknown,
+      ParseJson: (base, args) => JsonValue(base.v),
       Kind: (base, args) => String('string'),
+      Slice: (base, [start, end]) => {
+        const chars = codePoints(base.v);
+        const range = SliceRange(start, end, chars.length);
+
+        if (range.t === 'exception') {
+          return range;
+        }
+
+        return String(chars.slice(range.start, range.end).join(''));
+      },
     };
 
     export const methodArgLengths: {
@@ -73,10 +128,125 @@ namespace Outcome {
     } = {
       Length: 0,
       String: 0,
+      Binary: 0,
+      Json: 0,
+      ParseJson: 0,
       Kind: 0,
+      Slice: 2,
     };
   }
 
+  // :Slice(start, end) takes non-negative integer bounds with
+  // start <= end <= length, as in the VM
+  function SliceRange(
+    start: Value,
+    end: Value,
+    length: number,
+  ): { t: 'range', start: number, end: number } | Exception {
+    if (
+      start.t !== 'Number' ||
+      end.t !== 'Number' ||
+      start.v < 0 ||
+      end.v < 0 ||
+      start.v !== Math.floor(start.v) ||
+      end.v !== Math.floor(end.v)
+    ) {
+      return Exception(
+        null,
+        ['type-error'],
+        `Type error: slice bounds must be non-negative integers, got ` +
+        `${JsString(start)} and ${JsString(end)}`,
+      );
+    }
+
+    if (start.v > end.v || end.v > length) {
+      return Exception(
+        null,
+        ['out-of-bounds'],
+        `Slice out of range: (${start.v}, ${end.v}) of length ${length}`,
+      );
+    }
+
+    return { t: 'range', start: start.v, end: end.v };
+  }
+
+  // The VM's encodings depend on number types and formatting that the analyzer
+  // doesn't track, so their results are left unknown
+  function EncodingUnknown(base: Value, args: Value[]): Unknown {
+    return Unknown('info');
+  }
+
+  // Mirrors the VM's JsonMaxDepth
+  const JsonMaxDepth = 512;
+
+  // :ParseJson() for a known string. Numbers are parsed as f64, as in the
+  // VM. Duplicate keys, which the VM rejects, are not detected here because
+  // JSON.parse keeps the last one.
+  function JsonValue(text: string): Value | Exception {
+    let parsed: unknown;
+
+    try {
+      parsed = JSON.parse(text);
+    } catch (e) {
+      return Exception(null, ['syntax'], `Invalid JSON: ${e.message}`);
+    }
+
+    function convert(json: unknown, depth: number): Value | Exception {
+      if (typeof json === 'string') {
+        return String(json);
+      }
+
+      if (typeof json === 'number') {
+        return Number(json);
+      }
+
+      if (typeof json === 'boolean') {
+        return Bool(json);
+      }
+
+      if (json === null) {
+        return Null();
+      }
+
+      if (depth === JsonMaxDepth) {
+        return Exception(null, ['syntax'], 'JSON nested too deeply');
+      }
+
+      if (JsArray.isArray(json)) {
+        const values: Value[] = [];
+
+        for (const el of json) {
+          const value = convert(el, depth + 1);
+
+          if (value.t === 'exception') {
+            return value;
+          }
+
+          values.push(value);
+        }
+
+        return Array(values);
+      }
+
+      const dict = json as { [key: string]: unknown };
+      const values: { [key: string]: Value } = {};
+
+      for (const key of JsObject.keys(dict)) {
+        const value = convert(dict[key], depth + 1);
+
+        if (value.t === 'exception') {
+          return value;
+        }
+
+        values[key] = value;
+      }
+
+      return Object(values);
+    }
+
+    return convert(parsed, 0);
+  }
+
   export type Number = { cat: 'concrete', t: 'Number', v: number };
 
   export function Number(v: number): Number {
@@ -90,6 +260,16 @@ namespace Outcome {
         name: 'String';
         argLength: 0;
       };
+      Binary: {
+        base: Number;
+        name: 'Binary';
+        argLength: 0;
+      };
+      Json: {
+        base: Number;
+        name: 'Json';
+        argLength: 0;
+      };
       Kind: {
         base: Number;
         name: 'Kind';
@@ -104,6 +284,14 @@ namespace Outcome {
         args: [];
         result: String;
       };
+      Binary: {
+        args: [];
+        result: Unknown;
+      };
+      Json: {
+        args: [];
+        result: Unknown;
+      };
       Kind: {
         args: [];
         result: String;
@@ -117,6 +305,8 @@ namespace Outcome {
       >;
     } = {
       String: (base, args) => String(base.v.toString()),
+      Binary: EncodingUnknown,
+      Json: EncodingUnknown,
       Kind: (base, args) => String('f64'),
     };
 
@@ -124,6 +314,8 @@ namespace Outcome {
       [name in keyof MethodMap]: MethodMap[name]['argLength'];
     } = {
       String: 0,
+      Binary: 0,
+      Json: 0,
       Kind: 0,
     };
   }
@@ -141,6 +333,16 @@ namespace Outcome {
         name: 'String';
         argLength: 0;
       };
+      Binary: {
+        base: Bool;
+        name: 'Binary';
+        argLength: 0;
+      };
+      Json: {
+        base: Bool;
+        name: 'Json';
+        argLength: 0;
+      };
       Kind: {
         base: Bool;
         name: 'Kind';
@@ -155,6 +357,14 @@ namespace Outcome {
         args: [];
         result: String;
       };
+      Binary: {
+        args: [];
+        result: Unknown;
+      };
+      Json: {
+        args: [];
+        result: Unknown;
+      };
       Kind: {
         args: [];
         result: String;
@@ -168,6 +378,8 @@ namespace Outcome {
       >;
     } = {
       String: (base, args) => String(base.v.toString()),
+      Binary: EncodingUnknown,
+      Json: EncodingUnknown,
       Kind: (base, args) => String('bool'),
     };
 
@@ -175,6 +387,8 @@ namespace Outcome {
       [name in keyof MethodMap]: MethodMap[name]['argLength'];
     } = {
       String: 0,
+      Binary: 0,
+      Json: 0,
       Kind: 0,
     };
   }
@@ -192,6 +406,16 @@ namespace Outcome {
         name: 'String';
         argLength: 0;
       };
+      Binary: {
+        base: Null;
+        name: 'Binary';
+        argLength: 0;
+      };
+      Json: {
+        base: Null;
+        name: 'Json';
+        argLength: 0;
+      };
       Kind: {
         base: Null;
         name: 'Kind';
@@ -206,6 +430,14 @@ namespace Outcome {
         args: [];
         result: String;
       };
+      Binary: {
+        args: [];
+        result: Unknown;
+      };
+      Json: {
+        args: [];
+        result: Unknown;
+      };
       Kind: {
         args: [];
         result: String;
@@ -219,6 +451,8 @@ namespace Outcome {
       >;
     } = {
       String: (base, args) => String('null'),
+      Binary: EncodingUnknown,
+      Json: EncodingUnknown,
       Kind: (base, args) => String('null'),
     };
 
@@ -226,6 +460,8 @@ namespace Outcome {
       [name in keyof MethodMap]: MethodMap[name]['argLength'];
     } = {
       String: 0,
+      Binary: 0,
+      Json: 0,
       Kind: 0,
     };
   }
@@ -407,6 +643,18 @@ namespace Outcome {
         argLength: 0;
       };
 
+      Binary: {
+        base: Array;
+        name: 'Binary';
+        argLength: 0;
+      };
+
+      Json: {
+        base: Array;
+        name: 'Json';
+        argLength: 0;
+      };
+
       Kind: {
         base: Array;
         name: 'Kind';
@@ -455,6 +703,12 @@ namespace Outcome {
         argLength: 1;
       };
 
+      reduceAssoc: {
+        base: Array;
+        name: 'reduceAssoc';
+        argLength: 1;
+      };
+
       reduceFrom: {
         base: Array;
         name: 'reduceFrom';
@@ -478,6 +732,12 @@ namespace Outcome {
         name: 'Transpose';
         argLength: 0;
       };
+
+      Slice: {
+        base: Array;
+        name: 'Slice';
+        argLength: 2;
+      };
     };
 
     export const nonEmptyMethods: string[] = [
@@ -486,6 +746,7 @@ namespace Outcome {
       'Head',
       'Tail',
       'reduce',
+      'reduceAssoc',
     ];
 
     export type Method = MethodMap[keyof MethodMap];
@@ -516,6 +777,16 @@ namespace Outcome {
         result: String;
       };
 
+      Binary: {
+        args: [];
+        result: Unknown;
+      };
+
+      Json: {
+        args: [];
+        result: Unknown;
+      };
+
       Kind: {
         args: [];
         result: String;
@@ -556,6 +827,11 @@ namespace Outcome {
         result: Array;
       };
 
+      reduceAssoc: {
+        args: [Func];
+        result: Array;
+      };
+
       reduceFrom: {
         args: [Value, Func];
         result: Array;
@@ -575,6 +851,11 @@ namespace Outcome {
         args: [];
         result: Array | Object;
       };
+
+      Slice: {
+        args: [Value, Value];
+        result: Array | Exception;
+      };
     };
 
     export const methodImpls: {
@@ -596,6 +877,8 @@ namespace Outcome {
       }),
       Values: (base, []) => base,
       String: (base, []) => String(JsString(base)),
+      Binary: EncodingUnknown,
+      Json: EncodingUnknown,
       Kind: (base, []) => String('array'),
       Front: (base, []) => base.v[0],
       Back: (base, []) => base.v[base.v.length - 1],
@@ -604,6 +887,7 @@ namespace Outcome {
       filter: () => { throw new Error('Needs special implementation'); },
       map: () => { throw new Error('Needs special implementation'); },
       reduce: () => { throw new Error('Needs special implementation'); },
+      reduceAssoc: () => { throw new Error('Needs special implementation'); },
       reduceFrom: () => { throw new Error('Needs special implementation'); },
       Row: (base, []) => Array([base]),
       Column: (base, []) => (Array(
@@ -611,6 +895,15 @@ namespace Outcome {
         (base as any).v.map((v: Value) => Array([v]))
       )),
       Transpose: () => { throw new Error('Needs special implementation'); },
+      Slice: (base, [start, end]) => {
+        const range = SliceRange(start, end, base.v.length);
+
+        if (range.t === 'exception') {
+          return range;
+        }
+
+        return Array(base.v.slice(range.start, range.end));
+      },
     };
 
     export const methodArgLengths: {
@@ -621,6 +914,8 @@ namespace Outcome {
       Keys: 0,
       Values: 0,
       String: 0,
+      Binary: 0,
+      Json: 0,
       Kind: 0,
       Front: 0,
       Back: 0,
@@ -629,10 +924,12 @@ namespace Outcome {
       map: 1,
       filter: 1,
       reduce: 1,
+      reduceAssoc: 1,
       reduceFrom: 2,
       Row: 0,
       Column: 0,
       Transpose: 0,
+      Slice: 2,
     };
   }
 
@@ -840,6 +1137,18 @@ namespace Outcome {
         argLength: 0;
       };
 
+      Binary: {
+        base: Set;
+        name: 'Binary';
+        argLength: 0;
+      };
+
+      Json: {
+        base: Set;
+        name: 'Json';
+        argLength: 0;
+      };
+
       Kind: {
         base: Set;
         name: 'Kind';
@@ -860,6 +1169,16 @@ namespace Outcome {
         result: String;
       };
 
+      Binary: {
+        args: [];
+        result: Unknown;
+      };
+
+      Json: {
+        args: [];
+        result: Unknown;
+      };
+
       Kind: {
         args: [];
         result: String;
@@ -874,6 +1193,8 @@ namespace Outcome {
     } = {
       Values: (base, args) => Array(base.v),
       String: (base, args) => String(JsString(base)),
+      Binary: EncodingUnknown,
+      Json: EncodingUnknown,
       Kind: (base, args) => String('set'),
     };
 
@@ -882,6 +1203,8 @@ namespace Outcome {
     } = {
       Values: 0,
       String: 0,
+      Binary: 0,
+      Json: 0,
       Kind: 0,
     };
   }
@@ -981,6 +1304,18 @@ namespace Outcome {
         argLength: 0;
       };
 
+      Binary: {
+        base: Object;
+        name: 'Binary';
+        argLength: 0;
+      };
+
+      Json: {
+        base: Object;
+        name: 'Json';
+        argLength: 0;
+      };
+
       Kind: {
         base: Object;
         name: 'Kind';
@@ -1029,6 +1364,16 @@ namespace Outcome {
         result: String;
       };
 
+      Binary: {
+        args: [];
+        result: Unknown;
+      };
+
+      Json: {
+        args: [];
+        result: Unknown;
+      };
+
       Kind: {
         args: [];
         result: String;
@@ -1074,6 +1419,8 @@ namespace Outcome {
         )
       ),
       String: (base, args) => String(JsString(base)),
+      Binary: EncodingUnknown,
+      Json: EncodingUnknown,
       Kind: (base, args) => String('object'),
       Row: (base, []) => Array([base]),
       Column: (base, []) => {
@@ -1095,6 +1442,8 @@ namespace Outcome {
       Keys: 0,
       Values: 0,
       String: 0,
+      Binary: 0,
+      Json: 0,
       Kind: 0,
       Row: 0,
       Column: 0,
@@ -1836,7 +1836,9 @@ namespace Analyzer {
               return [ex, az];
             }
 
-            if (index.v >= container.v.length) {
+            const codePoints = Outcome.String.codePoints(container.v);
+
+            if (index.v >= codePoints.length) {
               const ex = Outcome.Exception(
                 exp,
                 ['out-of-bounds', 'index-too-large'],
@@ -1844,14 +1846,14 @@ namespace Analyzer {
                   'Out of bounds: index ',
                   index.v,
                   ' but string is only length ',
-                  container.v.length
+                  codePoints.length
                 ].join(''),
               );
 
               return [ex, az];
             }
 
-            const out = Outcome.String(container.v[index.v]);
+            const out = Outcome.String(codePoints[index.v]);
             return [out, az];
           }
 
@@ -2367,7 +2369,13 @@ namespace Analyzer {
           }
 
           // TODO: Reduce duplication with reduceFrom
-          if (base.t === 'Array' && funcDef.v.name === 'reduce') {
+          if (
+            base.t === 'Array' &&
+            (funcDef.v.name === 'reduce' || funcDef.v.name === 'reduceAssoc')
+          ) {
+            // :reduceAssoc may group the calls differently in the VM, which
+            // gives the same result because the reducer must be
+            // associative, so it's analyzed as :reduce
             const reducer = args[0];
 
             if (reducer.t !== 'Func') {
@@ -2386,7 +2394,8 @@ namespace Analyzer {
                 null,
                 ['type-error', 'arguments-length-mismatch'],
                 [
-                  ':reduce takes a function taking 2 arguments, but the ',
+                  `:${funcDef.v.name} takes a function taking 2 arguments, `,
+                  'but the ',
                   `provided function ${Outcome.LongString(reducer)} takes `,
                   `${argLength} argument(s)`,
                 ].join(''),
@@ -2,6 +2,7 @@ import CapturedNames from './CapturedNames';
 import formatLocation from './formatLocation';
 import Package from './Package';
 import Syntax from './parser/Syntax';
+import traverse from './traverse';
 
 type ByteCoder = {
   file: string,
@@ -17,13 +18,16 @@ type ByteCoder = {
   internalNames: {
     [name: string]: number | undefined,
   },
+
+  memo: boolean,
 };
 
-function ByteCoder(file: string): ByteCoder {
+function ByteCoder(file: string, memo: boolean = false): ByteCoder {
   return {
     file,
     names: {},
     internalNames: {},
+    memo,
   };
 }
 
@@ -78,6 +82,34 @@ namespace ByteCoder {
     }
   }
 
+  // With memo enabled, named functions start with `memo <n>` so the VM caches
+  // their results by their n arguments, which are the captures followed by the
+  // parameters. Functions that log are left alone because a cache hit would
+  // skip the log.
+  function Memo(
+    coder: ByteCoder,
+    fn: Syntax.FunctionExpression,
+    captureCount: number,
+  ): string[] {
+    const argc = captureCount + fn.v.args.length;
+
+    if (!coder.memo || argc > 255) {
+      return [];
+    }
+
+    const logs = traverse<Syntax.Element, Syntax.Element>(
+      fn,
+      el => el.t.indexOf('log.') === 0 ? [el] : [],
+      Syntax.Children,
+    );
+
+    if (logs.length > 0) {
+      return [];
+    }
+
+    return [`  memo ${argc}`];
+  }
+
   function getInternalName(
     coder: ByteCoder,
     name: string
@@ -225,6 +257,8 @@ namespace ByteCoder {
         lines.push(`gfunc $.captureless.${hoist.v.name.v} {`);
       }
 
+      lines.push(...Memo(coder, hoist, captures.length));
+
       const captureLines: string[] = [];
       const relabelledCaptures: string[] = [];
 
@@ -711,6 +745,12 @@ namespace ByteCoder {
             lines.push(`hoist $${exp.v.name.v}`);
             lines.push(`gfunc $${exp.v.name.v} {`);
           }
+
+          lines.push(...Memo(
+            coder,
+            exp,
+            captures.length + gfuncCaptures.length,
+          ));
         } else {
           lines.push(`func {`);
         }
@@ -11,8 +11,10 @@ namespace Vortex {
     Uint64 pos,
     Value&& val
   ) {
-    auto p = arr.persistent().insert(pos, val);
-    arr = p.transient();
+    // Moving through the persistent form keeps the tree uniquely owned, so
+    // immer can insert into existing nodes instead of copying the path.
+    auto p = std::move(arr).persistent().insert(pos, std::move(val));
+    arr = std::move(p).transient();
   }
 
   bool Array::operator==(const Array& right) const {
@@ -78,6 +80,21 @@ namespace Vortex {
     return values[i];
   }
 
+  Value Array::extract(Uint64 i) {
+    if (i >= values.size()) {
+      throw BadIndexError("Attempt to index past the end of an array");
+    }
+
+    Value res;
+
+    values.update(i, [&](Value&& v) {
+      res = std::move(v);
+      return Value(Value::null());
+    });
+
+    return res;
+  }
+
   bool Array::hasIndex(Uint64 i) const {
     return i < values.size();
   }
@@ -207,6 +224,10 @@ namespace Vortex {
       Array rightInnerKeys = right.InnerKeys();
       Uint64 rightInnerKeyLen = rightInnerKeys.Length();
 
+      // Every row has the same keys, so they share one index
+      auto proto = Object{.keys = rightInnerKeys};
+      proto.reindex();
+
       Uint64 len = Length();
       for (auto i = 0ul; i < len; ++i) {
         const Value& v = values[i];
@@ -231,10 +252,9 @@ namespace Vortex {
           row.push_back(std::move(sum));
         }
 
-        matrix.push_back(Value(new Object{
-          .keys = rightInnerKeys,
-          .values = Array{.values = std::move(row)}
-        }));
+        auto res = Value(new Object(proto));
+        res.data.OBJECT->values = Array{.values = std::move(row)};
+        matrix.push_back(std::move(res));
       }
 
       values = std::move(matrix);
@@ -299,6 +319,10 @@ namespace Vortex {
       Array rightInnerKeys = right.InnerKeys();
       Uint64 rightInnerKeyLen = rightInnerKeys.Length();
 
+      // Every row has the same keys, so they share one index
+      auto proto = Object{.keys = rightInnerKeys};
+      proto.reindex();
+
       Uint64 len = Length();
       for (auto i = 0ul; i < len; ++i) {
         const Value& v = values[i];
@@ -327,10 +351,9 @@ namespace Vortex {
           row.push_back(std::move(sum));
         }
 
-        matrix.push_back(Value(new Object{
-          .keys = rightInnerKeys,
-          .values = Array{.values = std::move(row)}
-        }));
+        auto res = Value(new Object(proto));
+        res.data.OBJECT->values = Array{.values = std::move(row)};
+        matrix.push_back(std::move(res));
       }
 
       values = std::move(matrix);
@@ -28,6 +28,11 @@ namespace Vortex {
     void pushFront(Value&& value);
     void update(Uint64 i, Value&& value);
     Value at(Uint64 i) const;
+
+    // Moves element i out and leaves null in its place. The element's
+    // payload isn't copied unless this array shares its leaf with another.
+    Value extract(Uint64 i);
+
     bool hasIndex(Uint64 i) const;
     void concat(Array&& right);
     void plus(const Array& right);
@@ -0,0 +1,447 @@
+#include <cstring>
+#include <type_traits>
+
+#include <immer/algorithm.hpp>
+#include <immer/flex_vector_transient.hpp>
+
+#include "Array.hpp"
+#include "Binary.hpp"
+#include "Object.hpp"
+#include "Set.hpp"
+
+namespace Vortex {
+  const char BinaryMagic[] = {'v', 'x', 'b'};
+
+  BinaryTag NumberTag(Code type) {
+    switch (type) {
+      case UINT8: return BinaryTag::UINT8;
+      case UINT16: return BinaryTag::UINT16;
+      case UINT32: return BinaryTag::UINT32;
+      case UINT64: return BinaryTag::UINT64;
+      case INT8: return BinaryTag::INT8;
+      case INT16: return BinaryTag::INT16;
+      case INT32: return BinaryTag::INT32;
+      case INT64: return BinaryTag::INT64;
+      case FLOAT32: return BinaryTag::FLOAT32;
+      case FLOAT64: return BinaryTag::FLOAT64;
+
+      default:
+        throw InternalError("Not a number type");
+    }
+  }
+
+  // Unsigned integer with the same width as T
+  template <typename T>
+  using FixedBits = std::conditional_t<
+    sizeof(T) == 1, Uint8, std::conditional_t<
+    sizeof(T) == 2, Uint16, std::conditional_t<
+    sizeof(T) == 4, Uint32, Uint64
+  >>>;
+
+  template <typename T>
+  void PutFixed(std::string& out, T value) {
+    FixedBits<T> bits;
+    std::memcpy(&bits, &value, sizeof(T));
+
+    for (auto i = 0ul; i != sizeof(T); ++i) {
+      out.push_back(char(bits >> (8ul * i)));
+    }
+  }
+
+  void PutLength(std::string& out, Uint64 len) {
+    while (len >= 0x80ul) {
+      out.push_back(char(len | 0x80ul));
+      len >>= 7;
+    }
+
+    out.push_back(char(len));
+  }
+
+  void PutTag(std::string& out, BinaryTag tag) {
+    out.push_back(char(tag));
+  }
+
+  void PutNumber(std::string& out, const Value& value) {
+    switch (value.type) {
+      case UINT8: PutFixed(out, value.data.UINT8); return;
+      case UINT16: PutFixed(out, value.data.UINT16); return;
+      case UINT32: PutFixed(out, value.data.UINT32); return;
+      case UINT64: PutFixed(out, value.data.UINT64); return;
+      case INT8: PutFixed(out, value.data.INT8); return;
+      case INT16: PutFixed(out, value.data.INT16); return;
+      case INT32: PutFixed(out, value.data.INT32); return;
+      case INT64: PutFixed(out, value.data.INT64); return;
+      case FLOAT32: PutFixed(out, value.data.FLOAT32); return;
+      case FLOAT64: PutFixed(out, value.data.FLOAT64); return;
+
+      default:
+        throw InternalError("Not a number type");
+    }
+  }
+
+  void PutString(std::string& out, const String& str) {
+    PutLength(out, str.size());
+
+    immer::for_each_chunk(str, [&](const char* first, const char* last) {
+      out.append(first, last);
+    });
+  }
+
+  bool IsPackable(const Array& arr) {
+    auto len = arr.Length();
+
+    if (len < 2ul || !isNumeric(arr.values[0].type)) {
+      return false;
+    }
+
+    Code type = arr.values[0].type;
+
+    for (const auto& v: arr.values) {
+      if (v.type != type) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void PutItem(std::string& out, const Value& value) {
+    switch (value.type) {
+      case NULL_: {
+        PutTag(out, BinaryTag::NULL_);
+        return;
+      }
+
+      case BOOL: {
+        PutTag(out, value.data.BOOL ? BinaryTag::TRUE : BinaryTag::FALSE);
+        return;
+      }
+
+      case UINT8:
+      case UINT16:
+      case UINT32:
+      case UINT64:
+      case INT8:
+      case INT16:
+      case INT32:
+      case INT64:
+      case FLOAT32:
+      case FLOAT64: {
+        PutTag(out, NumberTag(value.type));
+        PutNumber(out, value);
+        return;
+      }
+
+      case STRING: {
+        PutTag(out, BinaryTag::STRING);
+        PutString(out, *value.data.STRING);
+        return;
+      }
+
+      case ARRAY: {
+        const Array& arr = *value.data.ARRAY;
+
+        if (IsPackable(arr)) {
+          PutTag(out, BinaryTag::PACKED_ARRAY);
+          PutTag(out, NumberTag(arr.values[0].type));
+          PutLength(out, arr.Length());
+
+          for (const auto& v: arr.values) {
+            PutNumber(out, v);
+          }
+
+          return;
+        }
+
+        PutTag(out, BinaryTag::ARRAY);
+        PutLength(out, arr.Length());
+
+        for (const auto& v: arr.values) {
+          PutItem(out, v);
+        }
+
+        return;
+      }
+
+      case VSET: {
+        PutTag(out, BinaryTag::SET);
+        PutLength(out, value.data.SET->values.size());
+
+        for (const auto& v: value.data.SET->values) {
+          PutItem(out, v);
+        }
+
+        return;
+      }
+
+      case OBJECT: {
+        const Object& obj = *value.data.OBJECT;
+        auto keyIter = obj.keys.values.begin();
+        auto keyEnd = obj.keys.values.end();
+        auto valueIter = obj.values.values.begin();
+
+        PutTag(out, BinaryTag::OBJECT);
+        PutLength(out, obj.keys.Length());
+
+        for (; keyIter != keyEnd; ++keyIter, ++valueIter) {
+          PutString(out, *keyIter->data.STRING);
+          PutItem(out, *valueIter);
+        }
+
+        return;
+      }
+
+      case FUNC: {
+        throw TypeError("Can't encode function as binary");
+      }
+
+      default:
+        throw InternalError("Unrecognized value type");
+    }
+  }
+
+  void EncodeBinary(std::string& out, const Value& value) {
+    out.append(BinaryMagic, BinaryMagic + sizeof(BinaryMagic));
+    out.push_back(char(BinaryVersion));
+    PutItem(out, value);
+  }
+
+  struct BinaryReader {
+    const char* pos;
+    const char* end;
+    Uint64 depth = 0ul;
+
+    void descend() {
+      if (depth == BinaryMaxDepth) {
+        throw SyntaxError("Binary value nested too deeply");
+      }
+
+      depth++;
+    }
+
+    void need(Uint64 n) {
+      if (Uint64(end - pos) < n) {
+        throw SyntaxError("Binary value ends unexpectedly");
+      }
+    }
+
+    byte getByte() {
+      need(1ul);
+      return byte(*pos++);
+    }
+
+    template <typename T>
+    T getFixed() {
+      need(sizeof(T));
+
+      FixedBits<T> bits = 0;
+
+      for (auto i = 0ul; i != sizeof(T); ++i) {
+        bits |= FixedBits<T>(FixedBits<T>(byte(*pos++)) << (8ul * i));
+      }
+
+      T value;
+      std::memcpy(&value, &bits, sizeof(T));
+
+      return value;
+    }
+
+    Uint64 getLength() {
+      Uint64 len = 0ul;
+
+      for (Uint64 shift = 0ul; shift < 64ul; shift += 7ul) {
+        byte b = getByte();
+        len |= Uint64(b & 0x7f) << shift;
+
+        if ((b & 0x80) == 0) {
+          return len;
+        }
+      }
+
+      throw SyntaxError("Binary length too long");
+    }
+
+    String getString() {
+      auto len = getLength();
+      need(len);
+
+      auto str = String(pos, pos + len);
+      pos += len;
+
+      return str;
+    }
+
+    template <typename T>
+    Value getPacked(Uint64 len) {
+      // Checked up front, by division so a huge len can't overflow
+      if (len > Uint64(end - pos) / sizeof(T)) {
+        throw SyntaxError("Binary value ends unexpectedly");
+      }
+
+      immer::flex_vector_transient<Value> values;
+
+      for (auto i = 0ul; i != len; ++i) {
+        values.push_back(Value(getFixed<T>()));
+      }
+
+      return Value(new Array{.values = std::move(values)});
+    }
+
+    Value getNumber(BinaryTag tag) {
+      switch (tag) {
+        case BinaryTag::UINT8: return Value(getFixed<Uint8>());
+        case BinaryTag::UINT16: return Value(getFixed<Uint16>());
+        case BinaryTag::UINT32: return Value(getFixed<Uint32>());
+        case BinaryTag::UINT64: return Value(getFixed<Uint64>());
+        case BinaryTag::INT8: return Value(getFixed<Int8>());
+        case BinaryTag::INT16: return Value(getFixed<Int16>());
+        case BinaryTag::INT32: return Value(getFixed<Int32>());
+        case BinaryTag::INT64: return Value(getFixed<Int64>());
+        case BinaryTag::FLOAT32: return Value(getFixed<Float32>());
+        case BinaryTag::FLOAT64: return Value(getFixed<Float64>());
+
+        default:
+          throw SyntaxError("Invalid number tag");
+      }
+    }
+
+    Value getPackedArray() {
+      auto elementTag = BinaryTag(getByte());
+      auto len = getLength();
+
+      switch (elementTag) {
+        case BinaryTag::UINT8: return getPacked<Uint8>(len);
+        case BinaryTag::UINT16: return getPacked<Uint16>(len);
+        case BinaryTag::UINT32: return getPacked<Uint32>(len);
+        case BinaryTag::UINT64: return getPacked<Uint64>(len);
+        case BinaryTag::INT8: return getPacked<Int8>(len);
+        case BinaryTag::INT16: return getPacked<Int16>(len);
+        case BinaryTag::INT32: return getPacked<Int32>(len);
+        case BinaryTag::INT64: return getPacked<Int64>(len);
+        case BinaryTag::FLOAT32: return getPacked<Float32>(len);
+        case BinaryTag::FLOAT64: return getPacked<Float64>(len);
+
+        default:
+          throw SyntaxError("Invalid packed array element tag");
+      }
+    }
+
+    Value getItem() {
+      auto tag = BinaryTag(getByte());
+
+      switch (tag) {
+        case BinaryTag::NULL_: return Value(Value::null());
+        case BinaryTag::FALSE: return Value(false);
+        case BinaryTag::TRUE: return Value(true);
+
+        case BinaryTag::UINT8:
+        case BinaryTag::UINT16:
+        case BinaryTag::UINT32:
+        case BinaryTag::UINT64:
+        case BinaryTag::INT8:
+        case BinaryTag::INT16:
+        case BinaryTag::INT32:
+        case BinaryTag::INT64:
+        case BinaryTag::FLOAT32:
+        case BinaryTag::FLOAT64:
+          return getNumber(tag);
+
+        case BinaryTag::STRING: {
+          return Value(new String(getString()));
+        }
+
+        case BinaryTag::ARRAY: {
+          auto len = getLength();
+          auto res = Value(new Array());
+          descend();
+
+          for (auto i = 0ul; i != len; ++i) {
+            res.data.ARRAY->values.push_back(getItem());
+          }
+
+          depth--;
+          return res;
+        }
+
+        case BinaryTag::PACKED_ARRAY: {
+          return getPackedArray();
+        }
+
+        case BinaryTag::SET: {
+          auto len = getLength();
+          auto res = Value(new Set());
+          auto& values = res.data.SET->values;
+          descend();
+
+          for (auto i = 0ul; i != len; ++i) {
+            auto element = getItem();
+
+            if (
+              i != 0ul &&
+              TypeValueOrderUnchecked(values[i - 1ul], element) >= 0
+            ) {
+              throw SyntaxError("Binary set elements out of order");
+            }
+
+            values.push_back(std::move(element));
+          }
+
+          depth--;
+          return res;
+        }
+
+        case BinaryTag::OBJECT: {
+          auto len = getLength();
+          auto res = Value(new Object());
+          auto& obj = *res.data.OBJECT;
+          descend();
+
+          for (auto i = 0ul; i != len; ++i) {
+            auto key = Value(new String(getString()));
+
+            if (
+              i != 0ul &&
+              StringOrder(*obj.keys.values[i - 1ul].data.STRING, *key.data.STRING) >= 0
+            ) {
+              throw SyntaxError("Binary object keys out of order");
+            }
+
+            obj.keys.values.push_back(std::move(key));
+            obj.values.values.push_back(getItem());
+          }
+
+          depth--;
+          obj.reindex();
+          return res;
+        }
+
+        default:
+          throw SyntaxError("Invalid binary tag");
+      }
+    }
+  };
+
+  Value DecodeBinary(const char* first, const char* last) {
+    auto reader = BinaryReader{.pos = first, .end = last};
+
+    reader.need(sizeof(BinaryMagic) + 1ul);
+
+    if (std::memcmp(reader.pos, BinaryMagic, sizeof(BinaryMagic)) != 0) {
+      throw SyntaxError("Not a binary value");
+    }
+
+    reader.pos += sizeof(BinaryMagic);
+
+    if (reader.getByte() != BinaryVersion) {
+      throw NotImplementedError("Unsupported binary value version");
+    }
+
+    auto value = reader.getItem();
+
+    if (reader.pos != reader.end) {
+      throw SyntaxError("Trailing bytes after binary value");
+    }
+
+    return value;
+  }
+}
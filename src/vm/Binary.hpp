@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+
+#include "Value.hpp"
+
+namespace Vortex {
+  // Binary value format, used by :Binary() (which returns the bytes as a
+  // u8 array) and for caching values outside the VM. A value is written as
+  // the bytes 'v' 'x' 'b', a version byte, and then the root item. Each
+  // item is a BinaryTag byte followed by its payload:
+  //
+  //   numbers        fixed width, little endian
+  //   STRING         length, then the UTF-8 bytes
+  //   ARRAY          count, then the items
+  //   PACKED_ARRAY   element tag, count, then the elements' fixed width
+  //                  payloads back to back (arrays of two or more numbers
+  //                  of the same type)
+  //   SET            count, then the items in set order
+  //   OBJECT         count, then for each entry the key's length and bytes
+  //                  followed by the value item, in key order
+  //
+  // Lengths and counts are unsigned LEB128. Sets and objects are written
+  // in their sorted order, so decoding checks the order instead of
+  // sorting. Arrays, sets and objects may be nested BinaryMaxDepth deep.
+  constexpr byte BinaryVersion = 1;
+  constexpr Uint64 BinaryMaxDepth = 512ul;
+
+  enum class BinaryTag: byte {
+    NULL_,
+    FALSE,
+    TRUE,
+    UINT8,
+    UINT16,
+    UINT32,
+    UINT64,
+    INT8,
+    INT16,
+    INT32,
+    INT64,
+    FLOAT32,
+    FLOAT64,
+    STRING,
+    ARRAY,
+    PACKED_ARRAY,
+    SET,
+    OBJECT,
+  };
+
+  // Appends the encoding of value to out. Throws TypeError for values that
+  // contain functions.
+  void EncodeBinary(std::string& out, const Value& value);
+
+  // Decodes a complete encoding. Strings and packed arrays are built
+  // straight from the input range without an intermediate copy, and a
+  // packed array's element type is dispatched on once rather than per
+  // element. Throws SyntaxError if the input is malformed or nested too
+  // deeply and NotImplementedError for unknown versions.
+  Value DecodeBinary(const char* first, const char* last);
+}
@@ -16,6 +16,7 @@ namespace Vortex {
       case DISCARD:
       case GUARD:
       case UNGUARD:
+      case MEMO:
         return SPECIAL;
 
       case NULL_:
@@ -28,6 +28,7 @@ namespace Vortex {
     DISCARD,
     GUARD,
     UNGUARD,
+    MEMO,
 
     // TOP_TYPE
     NULL_,
@@ -2,6 +2,7 @@
 
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include <immer/flex_vector.hpp>
 
@@ -60,6 +61,46 @@ namespace Vortex {
 
     void prev() { pos--; }
 
+    // Skips code like skip(), collecting the id of every MCALL in it,
+    // including those in nested blocks and function literals
+    void findMCalls(Code code, std::vector<byte>& ids) {
+      if (code == MCALL) {
+        ids.push_back(getByte());
+        return;
+      }
+
+      bool isBlock = (
+        code == GFUNC ||
+        code == MFUNC ||
+        code == FUNC ||
+        code == ARRAY ||
+        code == VSET ||
+        code == OBJECT ||
+        code == LOOP ||
+        code == IF ||
+        code == ELSE
+      );
+
+      if (!isBlock) {
+        skip(code);
+        return;
+      }
+
+      if (code == GFUNC || code == MFUNC) {
+        get();
+      }
+
+      while (true) {
+        auto instr = get();
+
+        if (instr == END) {
+          return;
+        }
+
+        findMCalls(instr, ids);
+      }
+    }
+
     void skip(Code code) {
       switch (GetClass(code)) {
         case SPECIAL: {
@@ -80,6 +121,11 @@ namespace Vortex {
             break;
           }
 
+          if (code == MEMO) {
+            pos++;
+            break;
+          }
+
           if (code == LOCATION) {
             auto instr = get();
 
@@ -376,33 +422,37 @@ namespace Vortex {
         }
 
         case VSET: {
-          // TODO: Constructing the set one by one is an insertion sort and may
-          // be inefficient. Also perhaps the bytecode should require set
-          // literals to have elements in sorted order already. However a more
-          // sophisticated binary format for sets may be coming so I'm leaving
-          // this alone for now.
-
-          auto items = Value(new Set());
+          // Elements are collected first and then sorted and deduplicated in
+          // one go rather than inserted one by one.
+          // TODO: Perhaps the bytecode should require set literals to have
+          // elements in sorted order already.
+          std::vector<Value> elements;
 
           while (true) {
             auto elType = get();
 
             if (elType == END) {
+              auto items = Value(new Set());
+              items.data.SET->bulkInsert(std::move(elements));
               return items;
             }
 
-            items.data.SET->insert(getValue(elType));
+            elements.push_back(getValue(elType));
           }
         }
 
         case OBJECT: {
-          auto items = Value(new Object());
+          // Entries are collected so that the keys only need to be sorted
+          // once.
+          std::vector<std::pair<Value, Value>> entries;
 
           while (true) {
             auto keyType = get();
 
             switch (keyType) {
               case END: {
+                auto items = Value(new Object());
+                items.data.OBJECT->bulkInsert(std::move(entries));
                 return items;
               }
 
@@ -410,11 +460,9 @@ namespace Vortex {
                 // TODO: STRING shouldn't be implicit because later keys will
                 // be any type
                 Value key = getValue(STRING);
+                Value value = getValue(get());
 
-                items.data.OBJECT->insert(
-                  key,
-                  getValue(get())
-                );
+                entries.emplace_back(std::move(key), std::move(value));
 
                 continue;
               }
@@ -518,6 +566,10 @@ namespace Vortex {
           if (code == GUARD) { os << "guard" << std::endl; break; }
           if (code == UNGUARD) { os << "unguard" << std::endl; break; }
 
+          if (code == MEMO) {
+            os << "memo " << (int)getByte() << std::endl; break;
+          }
+
           throw InternalError("Unrecognized SPECIAL instruction");
         }
 
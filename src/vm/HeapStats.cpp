@@ -0,0 +1,105 @@
+#include <iomanip>
+#include <mutex>
+
+#include <sys/resource.h>
+
+#include "HeapStats.hpp"
+
+namespace Vortex {
+  const Code PayloadTypes[] = {STRING, ARRAY, VSET, OBJECT, FUNC};
+  const Uint64 PayloadTypeCount = sizeof(PayloadTypes) / sizeof(Code);
+
+  Uint64 PayloadSlot(Code type) {
+    return type - STRING;
+  }
+
+  // Each thread counts into its own table without synchronization and adds
+  // it to exitedCounts when it exits.
+  std::mutex exitedMutex;
+  HeapCounts exitedCounts[PayloadTypeCount];
+
+  struct ThreadCounts {
+    HeapCounts counts[PayloadTypeCount];
+
+    ~ThreadCounts() {
+      std::lock_guard<std::mutex> lock(exitedMutex);
+
+      for (auto i = 0ul; i != PayloadTypeCount; ++i) {
+        exitedCounts[i].live += counts[i].live;
+        exitedCounts[i].liveBytes += counts[i].liveBytes;
+        exitedCounts[i].allocated += counts[i].allocated;
+      }
+    }
+  };
+
+  thread_local ThreadCounts threadCounts;
+
+  void CountPayloadAlloc(Code type, Uint64 bytes) {
+    auto& counts = threadCounts.counts[PayloadSlot(type)];
+    counts.live++;
+    counts.liveBytes += bytes;
+    counts.allocated++;
+  }
+
+  void CountPayloadRelease(Code type, Uint64 bytes) {
+    auto& counts = threadCounts.counts[PayloadSlot(type)];
+    counts.live--;
+    counts.liveBytes -= bytes;
+  }
+
+  HeapCounts PayloadCounts(Code type) {
+    auto slot = PayloadSlot(type);
+    auto counts = threadCounts.counts[slot];
+
+    std::lock_guard<std::mutex> lock(exitedMutex);
+    counts.live += exitedCounts[slot].live;
+    counts.liveBytes += exitedCounts[slot].liveBytes;
+    counts.allocated += exitedCounts[slot].allocated;
+
+    return counts;
+  }
+
+  Int64 LivePayloads() {
+    Int64 live = 0;
+
+    for (auto type: PayloadTypes) {
+      live += PayloadCounts(type).live;
+    }
+
+    return live;
+  }
+
+  void PrintHeapStats(std::ostream& os) {
+    const char* names[] = {"string", "array", "set", "object", "func"};
+    HeapCounts total;
+
+    os << std::left << std::setw(8) << "type" << std::right;
+    os << std::setw(12) << "live";
+    os << std::setw(16) << "live bytes";
+    os << std::setw(16) << "allocated" << std::endl;
+
+    auto printRow = [&](const char* name, const HeapCounts& counts) {
+      os << std::left << std::setw(8) << name << std::right;
+      os << std::setw(12) << counts.live;
+      os << std::setw(16) << counts.liveBytes;
+      os << std::setw(16) << counts.allocated << std::endl;
+    };
+
+    for (auto i = 0ul; i != PayloadTypeCount; ++i) {
+      auto counts = PayloadCounts(PayloadTypes[i]);
+      printRow(names[i], counts);
+
+      total.live += counts.live;
+      total.liveBytes += counts.liveBytes;
+      total.allocated += counts.allocated;
+    }
+
+    printRow("total", total);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // ru_maxrss is in kilobytes on Linux
+    os << "peak rss: " << usage.ru_maxrss * 1024l << " bytes" << std::endl;
+  }
+}
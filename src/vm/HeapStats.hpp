@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ostream>
+
+#include "Codes.hpp"
+#include "types.hpp"
+
+namespace Vortex {
+  // Counters for the heap payloads owned by Values (STRING, ARRAY, VSET,
+  // OBJECT, FUNC). Bytes are the size of the payload header. The contents
+  // live in immer nodes that can be shared between many payloads, so they
+  // aren't attributed to any one of them.
+  struct HeapCounts {
+    Int64 live = 0;
+    Int64 liveBytes = 0;
+    Uint64 allocated = 0;
+  };
+
+  void CountPayloadAlloc(Code type, Uint64 bytes);
+  void CountPayloadRelease(Code type, Uint64 bytes);
+
+  // Totals over all threads that have exited plus the calling thread.
+  HeapCounts PayloadCounts(Code type);
+  Int64 LivePayloads();
+
+  void PrintHeapStats(std::ostream& os);
+}
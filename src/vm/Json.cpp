@@ -0,0 +1,518 @@
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <immer/algorithm.hpp>
+#include <immer/flex_vector_transient.hpp>
+
+#include "Array.hpp"
+#include "Json.hpp"
+#include "Object.hpp"
+#include "Set.hpp"
+
+namespace Vortex {
+  constexpr Uint64 ByteOnes = 0x0101010101010101ul;
+  constexpr Uint64 ByteHighs = 0x8080808080808080ul;
+
+  // Flags the bytes of word that end a plain run inside a JSON string: '"',
+  // '\\' and control characters. Borrows can also flag bytes after a real
+  // match, so callers only use this to decide whether a word is clean.
+  Uint64 StringStopMask(Uint64 word) {
+    auto zeroes = [](Uint64 x) { return (x - ByteOnes) & ~x & ByteHighs; };
+
+    return (
+      zeroes(word ^ (ByteOnes * Uint64('"'))) |
+      zeroes(word ^ (ByteOnes * Uint64('\\'))) |
+      ((word - ByteOnes * 0x20ul) & ~word & ByteHighs)
+    );
+  }
+
+  bool IsStringStop(char c) {
+    return c == '"' || c == '\\' || byte(c) < 0x20;
+  }
+
+  // Returns the first string stop in [pos, end), or end. Clean input is
+  // skipped eight bytes at a time.
+  const char* FindStringStop(const char* pos, const char* end) {
+    while (end - pos >= 8) {
+      Uint64 word;
+      std::memcpy(&word, pos, sizeof(word));
+
+      if (StringStopMask(word) != 0ul) {
+        break;
+      }
+
+      pos += 8;
+    }
+
+    while (pos != end && !IsStringStop(*pos)) {
+      ++pos;
+    }
+
+    return pos;
+  }
+
+  const char HexDigits[] = "0123456789abcdef";
+
+  void PutJsonChars(std::string& out, const char* first, const char* last) {
+    while (first != last) {
+      auto stop = FindStringStop(first, last);
+      out.append(first, stop);
+
+      if (stop == last) {
+        return;
+      }
+
+      char c = *stop;
+
+      switch (c) {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\b': out.append("\\b"); break;
+        case '\f': out.append("\\f"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+
+        default: {
+          char escape[] = {
+            '\\', 'u', '0', '0',
+            HexDigits[byte(c) >> 4],
+            HexDigits[byte(c) & 0xf],
+          };
+
+          out.append(escape, sizeof(escape));
+        }
+      }
+
+      first = stop + 1;
+    }
+  }
+
+  void PutJsonString(std::string& out, const String& str) {
+    out.push_back('"');
+
+    immer::for_each_chunk(str, [&](const char* first, const char* last) {
+      PutJsonChars(out, first, last);
+    });
+
+    out.push_back('"');
+  }
+
+  template <typename T>
+  void PutJsonNumber(std::string& out, T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+      if (!std::isfinite(value)) {
+        throw TypeError("Can't encode non-finite number as JSON");
+      }
+    }
+
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+  }
+
+  void PutJsonItem(std::string& out, const Value& value) {
+    switch (value.type) {
+      case NULL_: out.append("null"); return;
+      case BOOL: out.append(value.data.BOOL ? "true" : "false"); return;
+
+      case UINT8: PutJsonNumber(out, value.data.UINT8); return;
+      case UINT16: PutJsonNumber(out, value.data.UINT16); return;
+      case UINT32: PutJsonNumber(out, value.data.UINT32); return;
+      case UINT64: PutJsonNumber(out, value.data.UINT64); return;
+      case INT8: PutJsonNumber(out, value.data.INT8); return;
+      case INT16: PutJsonNumber(out, value.data.INT16); return;
+      case INT32: PutJsonNumber(out, value.data.INT32); return;
+      case INT64: PutJsonNumber(out, value.data.INT64); return;
+      case FLOAT32: PutJsonNumber(out, value.data.FLOAT32); return;
+      case FLOAT64: PutJsonNumber(out, value.data.FLOAT64); return;
+
+      case STRING: PutJsonString(out, *value.data.STRING); return;
+
+      case ARRAY: {
+        out.push_back('[');
+        bool first = true;
+
+        for (const auto& v: value.data.ARRAY->values) {
+          if (!first) {
+            out.push_back(',');
+          }
+
+          first = false;
+          PutJsonItem(out, v);
+        }
+
+        out.push_back(']');
+        return;
+      }
+
+      case VSET: {
+        out.push_back('[');
+        bool first = true;
+
+        for (const auto& v: value.data.SET->values) {
+          if (!first) {
+            out.push_back(',');
+          }
+
+          first = false;
+          PutJsonItem(out, v);
+        }
+
+        out.push_back(']');
+        return;
+      }
+
+      case OBJECT: {
+        const Object& obj = *value.data.OBJECT;
+        auto keyIter = obj.keys.values.begin();
+        auto keyEnd = obj.keys.values.end();
+        auto valueIter = obj.values.values.begin();
+
+        out.push_back('{');
+
+        for (; keyIter != keyEnd; ++keyIter, ++valueIter) {
+          if (keyIter != obj.keys.values.begin()) {
+            out.push_back(',');
+          }
+
+          if (keyIter->type != STRING) {
+            throw TypeError("Can't encode non-string key as JSON");
+          }
+
+          PutJsonString(out, *keyIter->data.STRING);
+          out.push_back(':');
+          PutJsonItem(out, *valueIter);
+        }
+
+        out.push_back('}');
+        return;
+      }
+
+      case FUNC: {
+        throw TypeError("Can't encode function as JSON");
+      }
+
+      default:
+        throw InternalError("Unrecognized value type");
+    }
+  }
+
+  void EncodeJson(std::string& out, const Value& value) {
+    PutJsonItem(out, value);
+  }
+
+  void PutUtf8(std::string& out, Uint32 codePoint) {
+    if (codePoint < 0x80u) {
+      out.push_back(char(codePoint));
+    } else if (codePoint < 0x800u) {
+      out.push_back(char(0xc0u | (codePoint >> 6)));
+      out.push_back(char(0x80u | (codePoint & 0x3fu)));
+    } else if (codePoint < 0x10000u) {
+      out.push_back(char(0xe0u | (codePoint >> 12)));
+      out.push_back(char(0x80u | ((codePoint >> 6) & 0x3fu)));
+      out.push_back(char(0x80u | (codePoint & 0x3fu)));
+    } else {
+      out.push_back(char(0xf0u | (codePoint >> 18)));
+      out.push_back(char(0x80u | ((codePoint >> 12) & 0x3fu)));
+      out.push_back(char(0x80u | ((codePoint >> 6) & 0x3fu)));
+      out.push_back(char(0x80u | (codePoint & 0x3fu)));
+    }
+  }
+
+  struct JsonReader {
+    const char* pos;
+    const char* end;
+    Uint64 depth = 0ul;
+
+    void skipSpace() {
+      while (
+        pos != end &&
+        (*pos == ' ' || *pos == '\n' || *pos == '\r' || *pos == '\t')
+      ) {
+        ++pos;
+      }
+    }
+
+    // Skips whitespace and then c if it comes next
+    bool consume(char c) {
+      skipSpace();
+
+      if (pos != end && *pos == c) {
+        ++pos;
+        return true;
+      }
+
+      return false;
+    }
+
+    void expect(char c) {
+      if (!consume(c)) {
+        throw SyntaxError(pos == end ? "JSON ends unexpectedly" : "Unexpected character in JSON");
+      }
+    }
+
+    void expectWord(const char* word, Uint64 len) {
+      if (Uint64(end - pos) < len || std::memcmp(pos, word, len) != 0) {
+        throw SyntaxError("Unexpected character in JSON");
+      }
+
+      pos += len;
+    }
+
+    Uint32 getHex4() {
+      if (end - pos < 4) {
+        throw SyntaxError("JSON ends unexpectedly");
+      }
+
+      Uint32 value = 0u;
+
+      for (auto i = 0; i != 4; ++i) {
+        char c = *pos++;
+        value <<= 4;
+
+        if (c >= '0' && c <= '9') {
+          value |= Uint32(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+          value |= Uint32(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+          value |= Uint32(c - 'A' + 10);
+        } else {
+          throw SyntaxError("Invalid unicode escape in JSON");
+        }
+      }
+
+      return value;
+    }
+
+    void getEscape(std::string& out) {
+      if (pos == end) {
+        throw SyntaxError("JSON ends unexpectedly");
+      }
+
+      switch (*pos++) {
+        case '"': out.push_back('"'); return;
+        case '\\': out.push_back('\\'); return;
+        case '/': out.push_back('/'); return;
+        case 'b': out.push_back('\b'); return;
+        case 'f': out.push_back('\f'); return;
+        case 'n': out.push_back('\n'); return;
+        case 'r': out.push_back('\r'); return;
+        case 't': out.push_back('\t'); return;
+
+        case 'u': {
+          Uint32 codePoint = getHex4();
+
+          if (codePoint >= 0xdc00u && codePoint <= 0xdfffu) {
+            throw SyntaxError("Unpaired surrogate in JSON");
+          }
+
+          if (codePoint >= 0xd800u && codePoint <= 0xdbffu) {
+            if (end - pos < 2 || pos[0] != '\\' || pos[1] != 'u') {
+              throw SyntaxError("Unpaired surrogate in JSON");
+            }
+
+            pos += 2;
+            Uint32 low = getHex4();
+
+            if (low < 0xdc00u || low > 0xdfffu) {
+              throw SyntaxError("Unpaired surrogate in JSON");
+            }
+
+            codePoint = 0x10000u + ((codePoint - 0xd800u) << 10) + (low - 0xdc00u);
+          }
+
+          PutUtf8(out, codePoint);
+          return;
+        }
+
+        default:
+          throw SyntaxError("Invalid escape in JSON");
+      }
+    }
+
+    // Reads a string whose opening quote has been consumed. Strings without
+    // escapes, which are most of them, are copied straight from the input.
+    String getString() {
+      auto stop = FindStringStop(pos, end);
+
+      if (stop != end && *stop == '"') {
+        auto str = String(pos, stop);
+        pos = stop + 1;
+        return str;
+      }
+
+      std::string buf;
+
+      while (true) {
+        buf.append(pos, stop);
+        pos = stop;
+
+        if (pos == end) {
+          throw SyntaxError("JSON ends unexpectedly");
+        }
+
+        char c = *pos++;
+
+        if (c == '"') {
+          return String(buf.begin(), buf.end());
+        }
+
+        if (c != '\\') {
+          throw SyntaxError("Unescaped control character in JSON string");
+        }
+
+        getEscape(buf);
+        stop = FindStringStop(pos, end);
+      }
+    }
+
+    void skipDigits() {
+      while (pos != end && *pos >= '0' && *pos <= '9') {
+        ++pos;
+      }
+    }
+
+    Value getNumber() {
+      auto start = pos;
+
+      if (*pos == '-') {
+        ++pos;
+      }
+
+      if (pos == end || *pos < '0' || *pos > '9') {
+        throw SyntaxError("Invalid number in JSON");
+      }
+
+      if (*pos == '0') {
+        ++pos;
+      } else {
+        skipDigits();
+      }
+
+      if (pos != end && *pos == '.') {
+        ++pos;
+
+        if (pos == end || *pos < '0' || *pos > '9') {
+          throw SyntaxError("Invalid number in JSON");
+        }
+
+        skipDigits();
+      }
+
+      if (pos != end && (*pos == 'e' || *pos == 'E')) {
+        ++pos;
+
+        if (pos != end && (*pos == '+' || *pos == '-')) {
+          ++pos;
+        }
+
+        if (pos == end || *pos < '0' || *pos > '9') {
+          throw SyntaxError("Invalid number in JSON");
+        }
+
+        skipDigits();
+      }
+
+      Float64 value = 0;
+      auto res = std::from_chars(start, pos, value);
+
+      if (res.ec == std::errc::result_out_of_range) {
+        throw SyntaxError("Number out of range in JSON");
+      }
+
+      return Value(value);
+    }
+
+    Value getArray() {
+      auto res = Value(new Array());
+      auto& values = res.data.ARRAY->values;
+
+      if (consume(']')) {
+        return res;
+      }
+
+      do {
+        values.push_back(getValue());
+      } while (consume(','));
+
+      expect(']');
+
+      return res;
+    }
+
+    Value getObject() {
+      std::vector<std::pair<Value, Value>> entries;
+
+      if (!consume('}')) {
+        do {
+          expect('"');
+          auto key = Value(new String(getString()));
+          expect(':');
+          entries.emplace_back(std::move(key), getValue());
+        } while (consume(','));
+
+        expect('}');
+      }
+
+      auto res = Value(new Object());
+      res.data.OBJECT->bulkInsert(std::move(entries));
+
+      return res;
+    }
+
+    Value getValue() {
+      skipSpace();
+
+      if (pos == end) {
+        throw SyntaxError("JSON ends unexpectedly");
+      }
+
+      switch (*pos) {
+        case '{':
+        case '[': {
+          if (depth == JsonMaxDepth) {
+            throw SyntaxError("JSON nested too deeply");
+          }
+
+          bool isObject = *pos++ == '{';
+
+          depth++;
+          auto res = isObject ? getObject() : getArray();
+          depth--;
+
+          return res;
+        }
+
+        case '"': {
+          ++pos;
+          return Value(new String(getString()));
+        }
+
+        case 't': expectWord("true", 4ul); return Value(true);
+        case 'f': expectWord("false", 5ul); return Value(false);
+        case 'n': expectWord("null", 4ul); return Value(Value::null());
+
+        default:
+          return getNumber();
+      }
+    }
+  };
+
+  Value ParseJson(const char* first, const char* last) {
+    auto reader = JsonReader{.pos = first, .end = last};
+    auto value = reader.getValue();
+
+    reader.skipSpace();
+
+    if (reader.pos != reader.end) {
+      throw SyntaxError("Trailing characters after JSON value");
+    }
+
+    return value;
+  }
+}
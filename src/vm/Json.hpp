@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+#include "Value.hpp"
+
+namespace Vortex {
+  // JSON conversion, used by :Json(), :ParseJson() and vxvm json.
+  //
+  // Parsed numbers are always f64 and parsed objects are built in one
+  // bulkInsert, so duplicate keys are rejected like they are in object
+  // literals. When encoding, every numeric type is written as a plain JSON
+  // number and sets are written as arrays in set order.
+  constexpr Uint64 JsonMaxDepth = 512ul;
+
+  // Appends the JSON text of value to out. Throws TypeError for functions
+  // and non-finite numbers, which JSON can't represent.
+  void EncodeJson(std::string& out, const Value& value);
+
+  // Parses one complete JSON text, allowing surrounding whitespace. Throws
+  // SyntaxError if the input is malformed.
+  Value ParseJson(const char* first, const char* last);
+}
@@ -1,12 +1,18 @@
 #pragma once
 
+#include <atomic>
 #include <deque>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "Codes.hpp"
 #include "Decoder.hpp"
 #include "Exceptions.hpp"
+#include "Memo.hpp"
+#include "Modules.hpp"
 #include "runBuiltInMethod.hpp"
 #include "Value.hpp"
 
@@ -33,20 +39,59 @@ namespace Vortex {
       }
     };
 
+    // A module function's value. It's shared by a machine and its forks,
+    // so each module is initialized once however many machines use it.
+    struct ModuleValue {
+      std::mutex mutex;
+      std::atomic<bool> completed{false};
+
+      // Not changed once completed is set
+      Value result = Value(Value::null());
+    };
+
     struct MFunc {
       Decoder code;
+
+      // Per machine, so a machine re-entering a module it's initializing is
+      // still caught as a loop
       bool entered = false;
-      bool completed = false;
 
-      // TODO: Should be able to default construct Value, but this is a
-      // workaround because MFunc gets copied and I don't know why yet
-      Value result = Value(Value::null());
+      std::shared_ptr<ModuleValue> value = std::make_shared<ModuleValue>();
     };
 
     std::deque<Value> calc;
     std::vector<Decoder> gfuncs;
     std::vector<MFunc> mfuncs;
 
+    // Per machine, keyed by gfunc id, so forks start with empty caches
+    std::unordered_map<byte, MemoCache> memos;
+
+    // Workers run part of a parallel built-in for another machine. They
+    // don't report exceptions, because the owning machine reruns the failed
+    // part itself so the error is reported as it would be sequentially.
+    bool worker = false;
+
+    // Whether exceptions are reported on std::cerr with their location.
+    // Embedding hosts turn this off and report errors their own way.
+    bool reportErrors = true;
+
+    // Set once the first module access has run InitModules, when module
+    // initialization is eager
+    bool modulesInitialized = false;
+
+    // Creates a worker with the same global functions. Code and values are
+    // immutable and immer's refcounts are atomic, so the copies share them
+    // with this machine rather than duplicating them, and module values are
+    // shared outright.
+    Machine fork() const {
+      auto res = Machine();
+      res.gfuncs = gfuncs;
+      res.mfuncs = mfuncs;
+      res.worker = true;
+
+      return res;
+    }
+
     Decoder getGFunc(byte i) {
       if (i >= gfuncs.size()) {
         throw InternalError("Global function does not exist");
@@ -72,23 +117,90 @@ namespace Vortex {
         throw InternalError("Global function does not exist");
       }
 
+      if (!worker && !modulesInitialized && EagerModules()) {
+        modulesInitialized = true;
+        InitModules(*this);
+      }
+
       MFunc& mfunc = mfuncs[i];
       Assert(mfunc.code.func.def.size() > 0ul);
+      ModuleValue& value = *mfunc.value;
 
-      if (mfunc.entered && !mfunc.completed) {
-        throw ModuleError("Infinite mfunc loop");
+      if (value.completed.load(std::memory_order_acquire)) {
+        calc.push_back(value.result);
+        return;
       }
 
-      if (mfunc.completed) {
-        calc.push_back(mfunc.result);
-        return;
+      if (mfunc.entered) {
+        throw ModuleError("Infinite mfunc loop");
       }
 
+      // Another machine may be initializing the same module. Waiting for it
+      // could deadlock on a cycle between machines, so instead the module
+      // is evaluated here too and the first result to finish is kept.
       mfunc.entered = true;
       callDecoder(mfunc.code);
-      mfunc.completed = true;
 
-      mfunc.result = calc.back();
+      std::lock_guard<std::mutex> lock(value.mutex);
+
+      if (value.completed.load(std::memory_order_relaxed)) {
+        calc.back() = value.result;
+      } else {
+        value.result = calc.back();
+        value.completed.store(true, std::memory_order_release);
+      }
+    }
+
+    // Calls a gfunc that starts with a memo annotation, using its cached
+    // result when it was last called with equal arguments
+    void gcallMemo(byte id, Decoder funcDecoder) {
+      funcDecoder.get();
+      Uint64 argc = funcDecoder.getByte();
+
+      if (argc > calc.size()) {
+        throw InternalError("Memoized gfunc called with too few arguments");
+      }
+
+      auto first = calc.end() - argc;
+      bool memoizable = std::all_of(first, calc.end(), [](const Value& arg) {
+        return arg.isFunctionless();
+      });
+
+      Uint64 hash = 0ul;
+      std::vector<Value> args;
+      MemoCache* cache = nullptr;
+
+      if (memoizable) {
+        for (auto iter = first; iter != calc.end(); ++iter) {
+          hash = HashCombine(hash, ValueHash(*iter));
+          args.push_back(*iter);
+        }
+
+        // unordered_map doesn't move its elements, so this stays valid
+        // while the call adds other caches
+        cache = &memos.try_emplace(id, id).first->second;
+        auto result = cache->find(hash, args.data(), argc);
+
+        if (result != nullptr) {
+          calc.erase(first, calc.end());
+          calc.push_back(*result);
+          return;
+        }
+      }
+
+      auto depth = calc.size() - argc;
+
+      cc.emplace_back();
+      run(funcDecoder);
+      cc.pop_back();
+
+      if (calc.size() != depth + 1ul) {
+        throw InternalError("Memoized gfunc didn't return one value");
+      }
+
+      if (cache != nullptr) {
+        cache->insert(hash, std::move(args), calc.back());
+      }
     }
 
     void setMFunc(byte i, Decoder decoder) {
@@ -203,6 +315,12 @@ namespace Vortex {
                   break;
                 }
 
+                case MEMO: {
+                  // Only read by GCALL
+                  pos.getByte();
+                  break;
+                }
+
                 case UNGUARD: {
                   Value guard = pop();
 
@@ -386,6 +504,16 @@ namespace Vortex {
                   int id = pos.getByte();
 
                   auto funcDecoder = getGFunc(id);
+
+                  if (
+                    !funcDecoder.end() &&
+                    funcDecoder.peek() == MEMO &&
+                    MemoSize() != 0ul
+                  ) {
+                    gcallMemo(id, std::move(funcDecoder));
+                    break;
+                  }
+
                   // TODO: Just make context a parameter of run?
                   // TODO: Use a shared stack for locals and use an offset?
                   cc.emplace_back();
@@ -413,6 +541,10 @@ namespace Vortex {
           }
         }
         catch (...) {
+          if (worker || !reportErrors) {
+            throw;
+          }
+
           std::cerr << "Threw exception at location " << location;
 
           if (ctx.location.type != NULL_) {
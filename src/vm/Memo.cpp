@@ -0,0 +1,186 @@
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+#include <mutex>
+
+#include "Array.hpp"
+#include "Memo.hpp"
+#include "Object.hpp"
+#include "Set.hpp"
+
+namespace Vortex {
+  std::atomic<Uint64> memoSize(DefaultMemoSize);
+
+  Uint64 MemoSize() {
+    return memoSize.load(std::memory_order_relaxed);
+  }
+
+  void SetMemoSize(Uint64 size) {
+    memoSize.store(size, std::memory_order_relaxed);
+  }
+
+  Uint64 HashCombine(Uint64 hash, Uint64 x) {
+    // The boost hash_combine step, widened to 64 bits
+    return hash ^ (x + 0x9e3779b97f4a7c15ul + (hash << 6) + (hash >> 2));
+  }
+
+  template <typename T>
+  Uint64 BitsHash(T x) {
+    Uint64 bits = 0ul;
+    std::memcpy(&bits, &x, sizeof(x));
+    return bits;
+  }
+
+  Uint64 ElementsHash(Uint64 hash, const Array& arr) {
+    hash = HashCombine(hash, arr.values.size());
+
+    for (const auto& v: arr.values) {
+      hash = HashCombine(hash, ValueHash(v));
+    }
+
+    return hash;
+  }
+
+  Uint64 ValueHash(const Value& value) {
+    Uint64 hash = value.type;
+
+    switch (value.type) {
+      case NULL_: return hash;
+      case BOOL: return HashCombine(hash, value.data.BOOL);
+
+      case UINT8: return HashCombine(hash, value.data.UINT8);
+      case UINT16: return HashCombine(hash, value.data.UINT16);
+      case UINT32: return HashCombine(hash, value.data.UINT32);
+      case UINT64: return HashCombine(hash, value.data.UINT64);
+
+      case INT8: return HashCombine(hash, BitsHash(value.data.INT8));
+      case INT16: return HashCombine(hash, BitsHash(value.data.INT16));
+      case INT32: return HashCombine(hash, BitsHash(value.data.INT32));
+      case INT64: return HashCombine(hash, BitsHash(value.data.INT64));
+
+      case FLOAT32: return HashCombine(hash, BitsHash(value.data.FLOAT32));
+      case FLOAT64: return HashCombine(hash, BitsHash(value.data.FLOAT64));
+
+      case STRING: return HashCombine(hash, StringHash(*value.data.STRING));
+
+      case ARRAY: return ElementsHash(hash, *value.data.ARRAY);
+
+      case VSET: {
+        hash = HashCombine(hash, value.data.SET->values.size());
+
+        for (const auto& v: value.data.SET->values) {
+          hash = HashCombine(hash, ValueHash(v));
+        }
+
+        return hash;
+      }
+
+      case OBJECT: {
+        hash = ElementsHash(hash, value.data.OBJECT->keys);
+        return ElementsHash(hash, value.data.OBJECT->values);
+      }
+
+      default:
+        throw InternalError("Unhashable value");
+    }
+  }
+
+  const Value* MemoCache::find(Uint64 hash, const Value* args, Uint64 argc) {
+    auto range = index.equal_range(hash);
+
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      auto entry = iter->second;
+
+      if (entry->args.size() != argc) {
+        continue;
+      }
+
+      bool equal = true;
+
+      for (auto i = 0ul; equal && i != argc; ++i) {
+        equal = TypeValueOrderUnchecked(entry->args[i], args[i]) == 0;
+      }
+
+      if (equal) {
+        entries.splice(entries.begin(), entries, entry);
+        hits++;
+        return &entry->result;
+      }
+    }
+
+    misses++;
+    return nullptr;
+  }
+
+  void MemoCache::insert(
+    Uint64 hash,
+    std::vector<Value>&& args,
+    const Value& result
+  ) {
+    auto size = MemoSize();
+
+    while (!entries.empty() && entries.size() >= size) {
+      auto last = std::prev(entries.end());
+      auto range = index.equal_range(last->hash);
+
+      for (auto iter = range.first; iter != range.second; ++iter) {
+        if (iter->second == last) {
+          index.erase(iter);
+          break;
+        }
+      }
+
+      entries.pop_back();
+      evictions++;
+    }
+
+    entries.push_front(Entry{hash, std::move(args), result});
+    index.emplace(hash, entries.begin());
+  }
+
+  struct MemoCounts {
+    Uint64 hits = 0ul;
+    Uint64 misses = 0ul;
+    Uint64 evictions = 0ul;
+  };
+
+  // Indexed by gfunc id
+  std::mutex memoCountsMutex;
+  MemoCounts memoCounts[256];
+
+  MemoCache::~MemoCache() {
+    std::lock_guard<std::mutex> lock(memoCountsMutex);
+    auto& counts = memoCounts[id];
+    counts.hits += hits;
+    counts.misses += misses;
+    counts.evictions += evictions;
+  }
+
+  void PrintMemoStats(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(memoCountsMutex);
+    bool header = false;
+
+    for (auto id = 0ul; id != 256ul; ++id) {
+      const auto& counts = memoCounts[id];
+
+      if (counts.hits + counts.misses == 0ul) {
+        continue;
+      }
+
+      if (!header) {
+        os << std::left << std::setw(12) << "memo" << std::right;
+        os << std::setw(12) << "hits";
+        os << std::setw(16) << "misses";
+        os << std::setw(16) << "evictions" << std::endl;
+        header = true;
+      }
+
+      os << std::left << std::setw(12) << ("gfunc " + std::to_string(id));
+      os << std::right;
+      os << std::setw(12) << counts.hits;
+      os << std::setw(16) << counts.misses;
+      os << std::setw(16) << counts.evictions << std::endl;
+    }
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <list>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "types.hpp"
+#include "Value.hpp"
+
+namespace Vortex {
+  // Memoization of global functions that start with a `memo <n>`
+  // annotation, which declares that the function takes n arguments and
+  // returns one value that only depends on them. Calls whose arguments
+  // contain functions aren't memoized.
+  //
+  // Each machine keeps an LRU cache per memoized function, holding up to
+  // MemoSize() results. The size is set by vxvm --memo-size, and 0 turns
+  // memoization off.
+  constexpr Uint64 DefaultMemoSize = 4096ul;
+
+  Uint64 MemoSize();
+  void SetMemoSize(Uint64 size);
+
+  Uint64 HashCombine(Uint64 hash, Uint64 x);
+
+  // Structural hash of a value without functions, consistent with
+  // TypeValueOrder: values that order equal hash equal, except 0 and -0.
+  Uint64 ValueHash(const Value& value);
+
+  struct MemoCache {
+    struct Entry {
+      Uint64 hash;
+      std::vector<Value> args;
+      Value result;
+    };
+
+    byte id;
+    Uint64 hits = 0ul;
+    Uint64 misses = 0ul;
+    Uint64 evictions = 0ul;
+
+    // Most recently used first
+    std::list<Entry> entries;
+    std::unordered_multimap<Uint64, std::list<Entry>::iterator> index;
+
+    explicit MemoCache(byte id): id(id) {}
+    MemoCache(const MemoCache&) = delete;
+    MemoCache& operator=(const MemoCache&) = delete;
+
+    // Adds this cache's counts to the totals PrintMemoStats reports
+    ~MemoCache();
+
+    // Returns the cached result for args and marks it most recently used,
+    // or nullptr
+    const Value* find(Uint64 hash, const Value* args, Uint64 argc);
+
+    void insert(Uint64 hash, std::vector<Value>&& args, const Value& result);
+  };
+
+  // Hits, misses and evictions of each memoized function, for machines
+  // that have been destroyed. Prints nothing if nothing was memoized.
+  void PrintMemoStats(std::ostream& os);
+}
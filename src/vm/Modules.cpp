@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include "Machine.hpp"
+#include "Modules.hpp"
+#include "Parallel.hpp"
+
+namespace Vortex {
+  std::atomic<bool> eagerModules(false);
+
+  bool EagerModules() {
+    return eagerModules.load(std::memory_order_relaxed);
+  }
+
+  void SetEagerModules(bool eager) {
+    eagerModules.store(eager, std::memory_order_relaxed);
+  }
+
+  bool IsPending(const Machine::MFunc& mfunc) {
+    return (
+      mfunc.code.func.def.size() > 0ul &&
+      !mfunc.value->completed.load(std::memory_order_acquire)
+    );
+  }
+
+  void InitModules(Machine& machine) {
+    auto count = machine.mfuncs.size();
+
+    if (ThreadCount() == 1ul || count < 2ul) {
+      return;
+    }
+
+    // waiting[i] is the number of modules i refers to that haven't been
+    // evaluated, and it's never released if one of them is undefined or
+    // can't be evaluated eagerly
+    std::vector<Uint64> waiting(count, 0ul);
+    std::vector<std::vector<Uint64>> dependents(count);
+    std::deque<Uint64> ready;
+    Uint64 pending = 0ul;
+
+    for (auto i = 0ul; i != count; ++i) {
+      const auto& mfunc = machine.mfuncs[i];
+
+      if (!IsPending(mfunc)) {
+        continue;
+      }
+
+      std::vector<byte> ids;
+      auto code = mfunc.code;
+      code.findMCalls(FUNC, ids);
+
+      std::sort(ids.begin(), ids.end());
+      ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+      for (auto id: ids) {
+        if (id >= count || machine.mfuncs[id].code.func.def.size() == 0ul) {
+          waiting[i]++;
+        } else if (IsPending(machine.mfuncs[id])) {
+          dependents[id].push_back(i);
+          waiting[i]++;
+        }
+      }
+
+      pending++;
+
+      if (waiting[i] == 0ul) {
+        ready.push_back(i);
+      }
+    }
+
+    if (ready.empty()) {
+      return;
+    }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    Uint64 running = 0ul;
+
+    auto work = [&]() {
+      auto worker = machine.fork();
+      std::unique_lock<std::mutex> lock(mutex);
+
+      while (true) {
+        changed.wait(lock, [&]() { return !ready.empty() || running == 0ul; });
+
+        if (ready.empty()) {
+          return;
+        }
+
+        auto i = ready.front();
+        ready.pop_front();
+        running++;
+        lock.unlock();
+
+        bool evaluated = true;
+
+        try {
+          // Publishes the value to every machine sharing the module
+          worker.getMFuncValue(i);
+          worker.pop();
+        } catch (...) {
+          evaluated = false;
+
+          // The worker's stack is left as it was when the module threw
+          worker = machine.fork();
+        }
+
+        lock.lock();
+        running--;
+
+        if (evaluated) {
+          for (auto d: dependents[i]) {
+            if (--waiting[d] == 0ul) {
+              ready.push_back(d);
+            }
+          }
+        }
+
+        changed.notify_all();
+      }
+    };
+
+    std::vector<std::future<void>> workers;
+
+    for (auto i = 1ul; i < std::min(ThreadCount(), pending); ++i) {
+      workers.push_back(std::async(std::launch::async, work));
+    }
+
+    work();
+
+    for (auto& w: workers) {
+      w.get();
+    }
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace Vortex {
+  struct Machine;
+
+  // Whether a machine initializes all its modules in parallel when one is
+  // first used, rather than each one when it's first used. Set by vxvm
+  // --eager-modules, and off by default.
+  bool EagerModules();
+  void SetEagerModules(bool eager);
+
+  // Evaluates the machine's module functions on up to ThreadCount() forks,
+  // each one once the modules it refers to have been evaluated.
+  //
+  // The dependencies come from the MCALLs anywhere in a module's code, so
+  // they're a superset of the ones evaluation can reach. Modules in a cycle
+  // of them, modules that depend on those, and modules whose evaluation
+  // fails are left to be evaluated lazily, which reports loops and errors
+  // just as it would have without eager initialization.
+  void InitModules(Machine& machine);
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include "Number.hpp"
+
+namespace Vortex {
+  template <typename T>
+  char* WriteDigits(char* buf, T value) {
+    return std::to_chars(buf, buf + NumberBufferSize, value).ptr;
+  }
+
+  // Writes a float like JavaScript's Number.prototype.toString: the
+  // shortest round-trip digits, in fixed notation for 1e-6 <= |value| <
+  // 1e21 and otherwise with an unpadded exponent (1e-7, 1.5e+21).
+  template <typename T>
+  char* WriteFloat(char* buf, T value) {
+    if (!std::isfinite(value)) {
+      return WriteDigits(buf, value);
+    }
+
+    // Scientific form gives the digits and exponent, e.g. -1.25e+02
+    char sci[NumberBufferSize];
+    auto sciEnd = std::to_chars(
+      sci,
+      sci + NumberBufferSize,
+      value,
+      std::chars_format::scientific
+    ).ptr;
+
+    auto out = buf;
+    auto p = sci;
+
+    if (*p == '-') {
+      *out++ = *p++;
+    }
+
+    char digits[NumberBufferSize];
+    int k = 0;
+
+    for (; *p != 'e'; ++p) {
+      if (*p != '.') {
+        digits[k++] = *p;
+      }
+    }
+
+    bool negativeExp = p[1] == '-';
+    int exp = 0;
+    std::from_chars(p + 2, sciEnd, exp);
+
+    // The decimal point goes after the first n digits
+    int n = (negativeExp ? -exp : exp) + 1;
+
+    if (k <= n && n <= 21) {
+      out = std::copy(digits, digits + k, out);
+      return std::fill_n(out, n - k, '0');
+    }
+
+    if (0 < n && n <= 21) {
+      out = std::copy(digits, digits + n, out);
+      *out++ = '.';
+      return std::copy(digits + n, digits + k, out);
+    }
+
+    if (-6 < n && n <= 0) {
+      *out++ = '0';
+      *out++ = '.';
+      out = std::fill_n(out, -n, '0');
+      return std::copy(digits, digits + k, out);
+    }
+
+    *out++ = digits[0];
+
+    if (k > 1) {
+      *out++ = '.';
+      out = std::copy(digits + 1, digits + k, out);
+    }
+
+    *out++ = 'e';
+    *out++ = n - 1 < 0 ? '-' : '+';
+
+    return WriteDigits(out, std::abs(n - 1));
+  }
+
+  char* WriteSuffix(char* buf, const char* suffix) {
+    auto len = std::strlen(suffix);
+    std::memcpy(buf, suffix, len);
+    return buf + len;
+  }
+
+  char* WriteNumber(char* buf, const Value& value) {
+    switch (value.type) {
+      case INT8: return WriteSuffix(WriteDigits(buf, (int)value.data.INT8), "i8");
+      case INT16: return WriteSuffix(WriteDigits(buf, value.data.INT16), "i16");
+      case INT32: return WriteDigits(buf, value.data.INT32);
+      case INT64: return WriteSuffix(WriteDigits(buf, value.data.INT64), "i64");
+
+      case UINT8: return WriteSuffix(WriteDigits(buf, (int)value.data.UINT8), "u8");
+      case UINT16: return WriteSuffix(WriteDigits(buf, value.data.UINT16), "u16");
+      case UINT32: return WriteSuffix(WriteDigits(buf, value.data.UINT32), "u32");
+      case UINT64: return WriteSuffix(WriteDigits(buf, value.data.UINT64), "u64");
+
+      case FLOAT32: return WriteSuffix(WriteFloat(buf, value.data.FLOAT32), "f32");
+
+      case FLOAT64: {
+        auto end = WriteFloat(buf, value.data.FLOAT64);
+
+        // f64 is the default number type, so integral values get a ".0" to
+        // tell them apart from i32. Exponent forms, inf and nan are already
+        // distinct.
+        for (auto p = buf; p != end; ++p) {
+          if (*p == '.' || *p == 'e' || *p == 'n') {
+            return end;
+          }
+        }
+
+        return WriteSuffix(end, ".0");
+      }
+
+      default:
+        throw InternalError("Attempt to write non-number as number");
+    }
+  }
+}
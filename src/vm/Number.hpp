@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Value.hpp"
+
+namespace Vortex {
+  // Large enough for any number WriteNumber produces, including its type
+  // suffix.
+  constexpr Uint64 NumberBufferSize = 48ul;
+
+  // Writes the literal form of a numeric Value (e.g. 3u64, -2i8, 1.5, 2.0)
+  // to buf and returns the end of what was written. Integers use
+  // std::to_chars, and floats use its shortest round-trip digits laid out
+  // the way JavaScript prints numbers, so nothing goes through a stream or
+  // allocates.
+  char* WriteNumber(char* buf, const Value& value);
+}
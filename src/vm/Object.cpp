@@ -1,5 +1,8 @@
+#include <algorithm>
+
 #include "LexOrder.hpp"
 #include "Object.hpp"
+#include "String.hpp"
 #include "Value.hpp"
 
 namespace Vortex {
@@ -81,26 +84,36 @@ namespace Vortex {
     Uint64 pos = binarySearch(key);
 
     if (pos == keys.Length()) {
+      if (indexed) {
+        addToIndex(StringHash(*key.data.STRING), pos);
+      }
+
       keys.pushBack(std::move(key));
       values.pushBack(std::move(value));
+
+      if (!indexed) {
+        countUnindexedInserts(1ul);
+      }
+
       return;
     }
 
-    if (*keys.at(pos).data.STRING == *key.data.STRING) {
+    if (*keys.values[pos].data.STRING == *key.data.STRING) {
       throw BadIndexError("Attempt to insert duplicate key");
     }
 
     TransientInsert(keys.values, pos, std::move(key));
     TransientInsert(values.values, pos, std::move(value));
+
+    index = KeyIndex();
+    indexed = false;
+    countUnindexedInserts(1ul);
   }
 
   void Object::update(const Value& key, Value value) {
-    Uint64 pos = binarySearch(key);
+    Uint64 pos = indexOf(key);
 
-    if (
-      pos == keys.Length() ||
-      *keys.at(pos).data.STRING != *key.data.STRING
-    ) {
+    if (pos == keys.Length()) {
       throw BadIndexError("Attempt to update key that does not exist");
     }
 
@@ -108,12 +121,9 @@ namespace Vortex {
   }
 
   Value Object::at(const Value& key) const {
-    Uint64 pos = binarySearch(key);
+    Uint64 pos = indexOf(key);
 
-    if (
-      pos == keys.Length() ||
-      *keys.at(pos).data.STRING != *key.data.STRING
-    ) {
+    if (pos == keys.Length()) {
       throw BadIndexError("Attempt to index with key that does not exist");
     }
 
@@ -121,31 +131,162 @@ namespace Vortex {
   }
 
   bool Object::hasIndex(const Value& key) const {
-    Uint64 pos = binarySearch(key);
+    return indexOf(key) != keys.Length();
+  }
 
-    if (pos == keys.Length()) {
-      return false;
+  template <typename Vec>
+  Vec Slice(const Vec& vec, Uint64 start, Uint64 end) {
+    return vec.drop(start).take(end - start);
+  }
+
+  void Object::concat(const Object& right) {
+    if (right.keys.Length() == 0ul) {
+      return;
     }
 
-    if (*keys.at(pos).data.STRING != *key.data.STRING) {
-      return false;
+    // Merges the two sorted key sequences in a single pass. Runs of keys that
+    // come from the same side are taken as slices, so their nodes are shared
+    // rather than copied element by element.
+    auto leftKeys = keys.values.persistent();
+    auto leftValues = values.values.persistent();
+    auto rightKeys = Array(right.keys).values.persistent();
+    auto rightValues = Array(right.values).values.persistent();
+
+    auto leftLen = leftKeys.size();
+    auto rightLen = rightKeys.size();
+
+    decltype(leftKeys) newKeys;
+    decltype(leftValues) newValues;
+
+    Uint64 i = 0ul;
+    Uint64 j = 0ul;
+
+    while (i < leftLen && j < rightLen) {
+      const String& rightKey = *rightKeys[j].data.STRING;
+      Uint64 start = i;
+
+      while (i < leftLen && StringOrder(*leftKeys[i].data.STRING, rightKey) < 0) {
+        i++;
+      }
+
+      newKeys = std::move(newKeys) + Slice(leftKeys, start, i);
+      newValues = std::move(newValues) + Slice(leftValues, start, i);
+
+      if (i == leftLen) {
+        break;
+      }
+
+      const String& leftKey = *leftKeys[i].data.STRING;
+      start = j;
+
+      while (j < rightLen) {
+        int cmp = StringOrder(*rightKeys[j].data.STRING, leftKey);
+
+        if (cmp == 0) {
+          throw BadIndexError("Attempt to insert duplicate key");
+        }
+
+        if (cmp > 0) {
+          break;
+        }
+
+        j++;
+      }
+
+      newKeys = std::move(newKeys) + Slice(rightKeys, start, j);
+      newValues = std::move(newValues) + Slice(rightValues, start, j);
     }
 
-    return true;
+    newKeys = std::move(newKeys) + leftKeys.drop(i) + rightKeys.drop(j);
+    newValues = std::move(newValues) + leftValues.drop(i) + rightValues.drop(j);
+
+    keys.values = std::move(newKeys).transient();
+    values.values = std::move(newValues).transient();
+
+    // The first j right keys landed inside the left range and the rest were
+    // appended after it. Appended keys don't shift any positions, so only the
+    // ones inside the range drop the index and count towards rebuilding it.
+    if (j == 0ul && indexed) {
+      for (auto k = 0ul; k != rightLen; ++k) {
+        addToIndex(StringHash(*rightKeys[k].data.STRING), leftLen + k);
+      }
+
+      return;
+    }
+
+    if (leftLen < IndexThreshold && leftLen + rightLen >= IndexThreshold) {
+      reindex();
+      return;
+    }
+
+    if (j != 0ul) {
+      index = KeyIndex();
+      indexed = false;
+    }
+
+    countUnindexedInserts(j);
   }
 
-  void Object::concat(const Object& right) {
-    auto sz = right.keys.Length();
-    Object res = *this;
+  void Object::bulkInsert(std::vector<std::pair<Value, Value>>&& entries) {
+    for (const auto& entry: entries) {
+      if (entry.first.type != STRING) {
+        throw NotImplementedError("Searching for location of non-string key");
+      }
+    }
+
+    std::stable_sort(
+      entries.begin(),
+      entries.end(),
+      [](const auto& a, const auto& b) {
+        return StringOrder(*a.first.data.STRING, *b.first.data.STRING) < 0;
+      }
+    );
+
+    Object sorted;
 
-    // TODO: There is a more efficient way to do this.
-    for (Uint64 pos = 0; pos < sz; pos++) {
-      this->insert(right.keys.at(pos), right.values.at(pos));
+    for (auto& entry: entries) {
+      auto sz = sorted.keys.Length();
+
+      if (
+        sz != 0ul &&
+        *sorted.keys.values[sz - 1ul].data.STRING == *entry.first.data.STRING
+      ) {
+        throw BadIndexError("Attempt to insert duplicate key");
+      }
+
+      sorted.keys.pushBack(std::move(entry.first));
+      sorted.values.pushBack(std::move(entry.second));
+    }
+
+    if (keys.Length() == 0ul) {
+      *this = std::move(sorted);
+      reindex();
+      return;
+    }
+
+    concat(sorted);
+  }
+
+  bool Object::sameKeys(const Object& right) const {
+    if (keys.Length() != right.keys.Length()) {
+      return false;
+    }
+
+    auto rightIter = right.keys.values.begin();
+
+    for (const Value& key: keys.values) {
+      if (*key.data.STRING != *rightIter->data.STRING) {
+        return false;
+      }
+
+      ++rightIter;
     }
+
+    return true;
   }
 
   void Object::plus(const Object& right) {
-    if (!(keys == right.keys)) {
+    if (!sameKeys(right)) {
       throw TypeError("Keys mismatch in Object + Object");
     }
 
@@ -153,7 +294,7 @@ namespace Vortex {
   }
 
   void Object::minus(const Object& right) {
-    if (!(keys == right.keys)) {
+    if (!sameKeys(right)) {
       throw TypeError("Keys mismatch in Object - Object");
     }
 
@@ -178,6 +319,8 @@ namespace Vortex {
       throw NotImplementedError("Searching for location of non-string key");
     }
 
+    const String& keyString = *key.data.STRING;
+
     Uint64 left = 0u;
     Uint64 right = keys.Length();
 
@@ -187,34 +330,107 @@ namespace Vortex {
 
     while (right - left > 1u) {
       Uint64 mid = left + (right - left) / 2u;
-      const Value& midValue = keys.at(mid);
+      const Value& midValue = keys.values[mid];
 
       if (midValue.type != STRING) {
         throw InternalError("Encountered non-string key during search");
       }
 
-      if (lexContainerOrder(
-        *key.data.STRING,
-        *midValue.data.STRING,
-        [](char a, char b) { return a - b; }
-      ) < 0) {
+      if (StringOrder(keyString, *midValue.data.STRING) < 0) {
         right = mid;
       } else {
         left = mid;
       }
     }
 
-    if (lexContainerOrder(
-      *keys.at(left).data.STRING,
-      *key.data.STRING,
-      [](char a, char b) { return a - b; }
-    ) < 0) {
+    if (StringOrder(*keys.values[left].data.STRING, keyString) < 0) {
       left++;
     }
 
     return left;
   }
 
+  Uint64 Object::indexOf(const Value& key) const {
+    if (key.type != STRING) {
+      throw NotImplementedError("Searching for location of non-string key");
+    }
+
+    Uint64 len = keys.Length();
+
+    if (indexed) {
+      const Uint64* pos = index.find(StringHash(*key.data.STRING));
+
+      if (pos == nullptr) {
+        return len;
+      }
+
+      if (*pos != AmbiguousKey) {
+        if (*keys.values[*pos].data.STRING != *key.data.STRING) {
+          return len;
+        }
+
+        return *pos;
+      }
+    }
+
+    Uint64 pos = binarySearch(key);
+
+    if (pos == len || *keys.values[pos].data.STRING != *key.data.STRING) {
+      return len;
+    }
+
+    return pos;
+  }
+
+  void Object::reindex() {
+    index = KeyIndex();
+    indexed = false;
+    unindexedInserts = 0ul;
+
+    if (keys.Length() < IndexThreshold) {
+      return;
+    }
+
+    indexed = true;
+    Uint64 pos = 0ul;
+
+    for (const Value& key: keys.values) {
+      addToIndex(StringHash(*key.data.STRING), pos);
+      pos++;
+    }
+  }
+
+  void Object::addToIndex(Uint64 hash, Uint64 pos) {
+    // Keys whose hashes collide are marked ambiguous, and lookups for them
+    // fall back to binarySearch.
+    if (index.count(hash) != 0ul) {
+      index = index.set(hash, AmbiguousKey);
+      return;
+    }
+
+    index = index.set(hash, pos);
+  }
+
+  void Object::countUnindexedInserts(Uint64 count) {
+    // Rebuilding after every insert before the end would make building a
+    // large object in unsorted key order quadratic, so the rebuild waits
+    // until its cost is covered by the inserts since the index was dropped,
+    // or until the object first reaches IndexThreshold keys.
+    unindexedInserts += count;
+    Uint64 len = keys.Length();
+
+    if (len < IndexThreshold) {
+      return;
+    }
+
+    if (
+      len - count < IndexThreshold ||
+      unindexedInserts >= len / IndexRebuildRatio
+    ) {
+      reindex();
+    }
+  }
+
   Uint64 Object::InnerLength() const { return values.InnerLength(); }
   Array Object::InnerKeys() const { return values.InnerKeys(); }
 }
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <utility>
+#include <vector>
+
+#include <immer/map.hpp>
+
 #include "Array.hpp"
 #include "Exceptions.hpp"
 #include "types.hpp"
@@ -9,6 +14,23 @@ namespace Vortex {
     Array keys;
     Array values;
 
+    // Objects with many keys also keep a hash index from key hash to
+    // position. It's only changed by mutations, so lookups never write to
+    // the object and it can be read from several threads. The index is
+    // persistent so copies share it and appending a key extends it cheaply,
+    // but inserting before the end shifts positions and drops it. A dropped
+    // index is rebuilt once enough keys have been inserted to pay for the
+    // rebuild, and until then lookups use binarySearch.
+    using KeyIndex = immer::map<Uint64, Uint64>;
+
+    static constexpr Uint64 IndexThreshold = 64ul;
+    static constexpr Uint64 IndexRebuildRatio = 4ul;
+    static constexpr Uint64 AmbiguousKey = ~0ul;
+
+    KeyIndex index;
+    bool indexed = false;
+    Uint64 unindexedInserts = 0ul;
+
     bool operator==(const Object& right) const;
     bool operator<(const Object& right) const;
 
@@ -21,11 +43,20 @@ namespace Vortex {
     Value at(const Value& key) const;
     bool hasIndex(const Value& key) const;
     void concat(const Object& right);
+    void bulkInsert(std::vector<std::pair<Value, Value>>&& entries);
+    bool sameKeys(const Object& right) const;
     void plus(const Object& right);
     void minus(const Object& right);
     void multiply(const Value& right);
 
     Uint64 binarySearch(const Value& key) const;
+    Uint64 indexOf(const Value& key) const;
+
+    // Builds the index if there are enough keys, for objects whose keys
+    // were set directly
+    void reindex();
+    void addToIndex(Uint64 hash, Uint64 pos);
+    void countUnindexedInserts(Uint64 count);
 
     Uint64 InnerLength() const;
     Array InnerKeys() const;
@@ -0,0 +1,34 @@
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+#include <immer/memory_policy.hpp>
+
+#include "Parallel.hpp"
+
+namespace Vortex {
+  // Worker machines share immer trees with the machine that forked them,
+  // which is only safe with atomic reference counts. immer uses them
+  // unless it's built with IMMER_NO_THREAD_SAFETY.
+  static_assert(
+    std::is_same_v<immer::default_refcount_policy, immer::refcount_policy>,
+    "Parallel evaluation requires immer's thread safe refcount policy"
+  );
+
+  Uint64 DefaultThreadCount() {
+    Uint64 count = std::thread::hardware_concurrency();
+
+    // hardware_concurrency is 0 when it can't be determined
+    return count == 0ul ? 1ul : count;
+  }
+
+  std::atomic<Uint64> threadCount(DefaultThreadCount());
+
+  Uint64 ThreadCount() {
+    return threadCount.load(std::memory_order_relaxed);
+  }
+
+  void SetThreadCount(Uint64 count) {
+    threadCount.store(count == 0ul ? 1ul : count, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "types.hpp"
+
+namespace Vortex {
+  // Number of threads that parallel built-ins (:map, :reduceAssoc) may
+  // use, set by vxvm --threads. Defaults to the hardware concurrency, and
+  // 1 means everything runs on the calling thread.
+  Uint64 ThreadCount();
+  void SetThreadCount(Uint64 count);
+}
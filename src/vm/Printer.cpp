@@ -0,0 +1,257 @@
+#include <cstring>
+
+#include <immer/algorithm.hpp>
+
+#include "Array.hpp"
+#include "Number.hpp"
+#include "Object.hpp"
+#include "Printer.hpp"
+#include "Set.hpp"
+
+namespace Vortex {
+  bool isStringAtomic(const Value& value) {
+    switch (value.type) {
+      case ARRAY:
+      case VSET:
+      case OBJECT:
+        return false;
+
+      default:
+        return true;
+    }
+  }
+
+  template <typename C>
+  bool containsOnlyStringAtomics(const C& container) {
+    for (const auto& v: container) {
+      if (!isStringAtomic(v)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool isIdentifier(const String& str) {
+    bool first = true;
+    bool valid = true;
+
+    immer::for_each_chunk(str, [&](const char* p, const char* last) {
+      for (; valid && p != last; ++p) {
+        char c = *p;
+
+        valid = (
+          c == '_' ||
+          ('a' <= c && c <= 'z') ||
+          ('A' <= c && c <= 'Z') ||
+          (!first && '0' <= c && c <= '9')
+        );
+
+        first = false;
+      }
+    });
+
+    return valid;
+  }
+
+  Printer::Printer(std::ostream& os): os(os) {
+    buffer.reserve(BufferSize + NumberBufferSize);
+  }
+
+  Printer::~Printer() {
+    flush();
+  }
+
+  void Printer::print(const Value& value, Uint64 depth) {
+    switch (value.type) {
+      case NULL_: {
+        write("null");
+        break;
+      }
+
+      case BOOL: {
+        write(value.data.BOOL ? "true" : "false");
+        break;
+      }
+
+      case INT8:
+      case INT16:
+      case INT32:
+      case INT64:
+      case UINT8:
+      case UINT16:
+      case UINT32:
+      case UINT64:
+      case FLOAT32:
+      case FLOAT64: {
+        char buf[NumberBufferSize];
+        write(buf, WriteNumber(buf, value));
+        break;
+      }
+
+      case ARRAY: {
+        printElements(value.data.ARRAY->values, depth);
+        break;
+      }
+
+      case VSET: {
+        put('#');
+        printElements(value.data.SET->values, depth);
+        break;
+      }
+
+      case STRING: {
+        printQuoted(*value.data.STRING);
+        break;
+      }
+
+      case OBJECT: {
+        const Object& obj = *value.data.OBJECT;
+        auto keyIter = obj.keys.values.begin();
+        auto keyEnd = obj.keys.values.end();
+        auto valueIter = obj.values.values.begin();
+
+        put('{');
+
+        if (containsOnlyStringAtomics(obj.values.values)) {
+          bool notFirst = false;
+
+          for (; keyIter != keyEnd; ++keyIter, ++valueIter) {
+            if (notFirst) {
+              write(", ");
+            }
+
+            printKey(*keyIter);
+            write(": ");
+            print(*valueIter, depth);
+            notFirst = true;
+          }
+        } else {
+          for (; keyIter != keyEnd; ++keyIter, ++valueIter) {
+            newline(depth + 1ul);
+            printKey(*keyIter);
+            write(": ");
+            print(*valueIter, depth + 1ul);
+            put(',');
+          }
+
+          newline(depth);
+        }
+
+        put('}');
+        break;
+      }
+
+      case FUNC: {
+        write("<func>");
+        break;
+      }
+
+      default:
+        throw InternalError("Unrecognized value type");
+    }
+  }
+
+  template <typename Values>
+  void Printer::printElements(const Values& values, Uint64 depth) {
+    put('[');
+
+    if (containsOnlyStringAtomics(values)) {
+      bool notFirst = false;
+
+      for (const auto& v: values) {
+        if (notFirst) {
+          write(", ");
+        }
+
+        print(v, depth);
+        notFirst = true;
+      }
+    } else {
+      for (const auto& v: values) {
+        newline(depth + 1ul);
+        print(v, depth + 1ul);
+        put(',');
+      }
+
+      newline(depth);
+    }
+
+    put(']');
+  }
+
+  void Printer::printKey(const Value& key) {
+    if (key.type == STRING && isIdentifier(*key.data.STRING)) {
+      printRaw(*key.data.STRING);
+      return;
+    }
+
+    print(key);
+  }
+
+  void Printer::printQuoted(const String& str) {
+    put('\'');
+
+    immer::for_each_chunk(str, [&](const char* first, const char* last) {
+      auto runStart = first;
+
+      for (; first != last; ++first) {
+        if (*first == '\'' || *first == '\\') {
+          write(runStart, first);
+          put('\\');
+          put(*first);
+          runStart = first + 1;
+        }
+      }
+
+      write(runStart, last);
+    });
+
+    put('\'');
+  }
+
+  void Printer::printRaw(const String& str) {
+    immer::for_each_chunk(str, [&](const char* first, const char* last) {
+      write(first, last);
+    });
+  }
+
+  void Printer::put(char c) {
+    buffer.push_back(c);
+
+    if (buffer.size() >= BufferSize) {
+      flush();
+    }
+  }
+
+  void Printer::write(const char* first, const char* last) {
+    buffer.append(first, last);
+
+    if (buffer.size() >= BufferSize) {
+      flush();
+    }
+  }
+
+  void Printer::write(const char* str) {
+    write(str, str + std::strlen(str));
+  }
+
+  void Printer::newline(Uint64 depth) {
+    buffer.push_back('\n');
+    buffer.append(2ul * depth, ' ');
+
+    if (buffer.size() >= BufferSize) {
+      flush();
+    }
+  }
+
+  void Printer::flush() {
+    os.write(buffer.data(), buffer.size());
+    buffer.clear();
+  }
+
+  std::ostream& StreamLongString(std::ostream& os, const Value& value) {
+    Printer(os).print(value);
+    return os;
+  }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "Value.hpp"
+
+namespace Vortex {
+  // Writes Values in the layout of StreamLongString. Output collects in a
+  // buffer that is passed to the stream in blocks of about BufferSize, so
+  // the stream sees a few large writes. Nesting is tracked as a depth
+  // rather than as indent strings, and children are visited in place.
+  struct Printer {
+    static constexpr Uint64 BufferSize = 1ul << 16;
+
+    std::ostream& os;
+    std::string buffer;
+
+    explicit Printer(std::ostream& os);
+    ~Printer();
+
+    void print(const Value& value, Uint64 depth = 0ul);
+    void printKey(const Value& key);
+    void printQuoted(const String& str);
+    void printRaw(const String& str);
+
+    template <typename Values>
+    void printElements(const Values& values, Uint64 depth);
+
+    void put(char c);
+    void write(const char* first, const char* last);
+    void write(const char* str);
+    void newline(Uint64 depth);
+
+    // Passes the buffered output to the stream. The stream itself is not
+    // flushed.
+    void flush();
+  };
+}
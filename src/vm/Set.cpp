@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <vector>
 
+#include <immer/flex_vector.hpp>
 #include <immer/flex_vector_transient.hpp>
 
 #include "Array.hpp"
@@ -7,6 +9,19 @@
 #include "Value.hpp"
 
 namespace Vortex {
+  // Number of consecutive elements taken from one side of a merge before
+  // switching to galloping search.
+  const Uint64 MinGallop = 7ul;
+
+  // Runs shorter than this are copied element by element, longer ones are
+  // appended as slices.
+  const Uint64 SliceRunLength = 16ul;
+
+  template <typename Vec>
+  Vec Slice(const Vec& vec, Uint64 start, Uint64 end) {
+    return vec.drop(start).take(end - start);
+  }
+
   bool Set::operator==(const Set& right) const {
     return SetOrder(*this, right) == 0;
   }
@@ -41,20 +56,108 @@ namespace Vortex {
     }
   }
 
-  void Set::combine(
-    const Set& right,
+  using SetValues = immer::flex_vector<Value>;
+
+  // First position at or after start whose element is not less than target.
+  // Probes start, start + 1, start + 3, start + 7, ... and then binary
+  // searches the last gap, so skipping a run of length n takes O(log n)
+  // comparisons.
+  Uint64 Gallop(const SetValues& values, Uint64 start, const Value& target) {
+    Uint64 len = values.size();
+    Uint64 lo = start;
+    Uint64 hi = start;
+    Uint64 step = 1ul;
+
+    while (hi < len && TypeValueOrderUnchecked(values[hi], target) < 0) {
+      lo = hi + 1ul;
+      hi += step;
+      step *= 2ul;
+    }
+
+    hi = std::min(hi, len);
+
+    while (lo < hi) {
+      Uint64 mid = lo + (hi - lo) / 2ul;
+
+      if (TypeValueOrderUnchecked(values[mid], target) < 0) {
+        lo = mid + 1ul;
+      } else {
+        hi = mid;
+      }
+    }
+
+    return lo;
+  }
+
+  void AppendRun(
+    immer::flex_vector_transient<Value>& out,
+    const SetValues& src,
+    Uint64 start,
+    Uint64 end
+  ) {
+    if (end - start < SliceRunLength) {
+      for (auto i = start; i != end; ++i) {
+        out.push_back(src[i]);
+      }
+
+      return;
+    }
+
+    // Long runs are appended as a slice, which shares the source's nodes.
+    out.append(Slice(src, start, end).transient());
+  }
+
+  immer::flex_vector_transient<Value> CombineRange(
+    const SetValues& left,
+    const SetValues& right,
     bool keepInLeftOnly,
     bool keepInBoth,
     bool keepInRightOnly
   ) {
-    immer::flex_vector_transient<Value> newValues;
+    // Merges in lockstep, but once one side has produced MinGallop elements
+    // in a row it gallops to the end of that run instead. Sets of similar
+    // size and interleaving pay no extra comparisons, while a small set
+    // merged into a large one costs O(small * log(large)).
+    immer::flex_vector_transient<Value> out;
+
+    auto leftLen = left.size();
+    auto rightLen = right.size();
+
+    Uint64 i = 0ul;
+    Uint64 j = 0ul;
+    auto leftIter = left.begin();
+    auto rightIter = right.begin();
+
+    Uint64 leftWins = 0ul;
+    Uint64 rightWins = 0ul;
+
+    while (i < leftLen && j < rightLen) {
+      if (leftWins >= MinGallop) {
+        Uint64 next = Gallop(left, i, *rightIter);
+
+        if (keepInLeftOnly) {
+          AppendRun(out, left, i, next);
+        }
+
+        leftIter += next - i;
+        i = next;
+        leftWins = 0ul;
+        continue;
+      }
+
+      if (rightWins >= MinGallop) {
+        Uint64 next = Gallop(right, j, *leftIter);
 
-    auto leftIter = values.begin();
-    auto leftIterEnd = values.end();
-    auto rightIter = right.values.begin();
-    auto rightIterEnd = right.values.end();
+        if (keepInRightOnly) {
+          AppendRun(out, right, j, next);
+        }
+
+        rightIter += next - j;
+        j = next;
+        rightWins = 0ul;
+        continue;
+      }
 
-    while (leftIter != leftIterEnd && rightIter != rightIterEnd) {
       const Value& leftItem = *leftIter;
       const Value& rightItem = *rightIter;
 
@@ -62,45 +165,68 @@ namespace Vortex {
 
       if (cmp < 0) {
         if (keepInLeftOnly) {
-          newValues.push_back(leftItem);
+          out.push_back(leftItem);
         }
 
         ++leftIter;
+        ++i;
+        leftWins++;
+        rightWins = 0ul;
         continue;
       }
 
       if (cmp == 0) {
         if (keepInBoth) {
-          newValues.push_back(leftItem);
+          out.push_back(leftItem);
         }
 
         ++leftIter;
+        ++i;
         ++rightIter;
+        ++j;
+        leftWins = 0ul;
+        rightWins = 0ul;
         continue;
       }
 
       if (keepInRightOnly) {
-        newValues.push_back(rightItem);
+        out.push_back(rightItem);
       }
 
       ++rightIter;
+      ++j;
+      rightWins++;
+      leftWins = 0ul;
     }
 
     if (keepInLeftOnly) {
-      while (leftIter != leftIterEnd) {
-        newValues.push_back(*leftIter);
-        ++leftIter;
-      }
+      AppendRun(out, left, i, leftLen);
     }
 
     if (keepInRightOnly) {
-      while (rightIter != rightIterEnd) {
-        newValues.push_back(*rightIter);
-        ++rightIter;
-      }
+      AppendRun(out, right, j, rightLen);
     }
 
-    values = std::move(newValues);
+    return out;
+  }
+
+  void Set::combine(
+    const Set& right,
+    bool keepInLeftOnly,
+    bool keepInBoth,
+    bool keepInRightOnly
+  ) {
+    auto leftValues = values.persistent();
+    auto rightCopy = right.values;
+    auto rightValues = std::move(rightCopy).persistent();
+
+    values = CombineRange(
+      leftValues,
+      rightValues,
+      keepInLeftOnly,
+      keepInBoth,
+      keepInRightOnly
+    );
   }
 
   void Set::unify(const Set& right) {
@@ -126,8 +252,25 @@ namespace Vortex {
 
     auto sz = values.size();
 
+    if (sz == 0ul) {
+      values.push_back(std::move(element));
+      return;
+    }
+
+    // Elements often arrive in order, so check the end before searching.
+    int backCmp = TypeValueOrderUnchecked(element, values[sz - 1ul]);
+
+    if (backCmp == 0) {
+      return;
+    }
+
+    if (backCmp > 0) {
+      values.push_back(std::move(element));
+      return;
+    }
+
     auto left = 0ul;
-    auto right = sz;
+    auto right = sz - 1ul;
 
     while (left < right) {
       auto mid = left + (right - left) / 2;
@@ -150,6 +293,46 @@ namespace Vortex {
     TransientInsert(values, left, std::move(element));
   }
 
+  void Set::bulkInsert(std::vector<Value>&& elements) {
+    for (const Value& element: elements) {
+      if (!element.isFunctionless()) {
+        throw TypeError("Can\'t add non-functionless element to set");
+      }
+    }
+
+    // Stable so that, like repeated insert, the first of any equal elements
+    // is the one kept.
+    std::stable_sort(
+      elements.begin(),
+      elements.end(),
+      [](const Value& a, const Value& b) {
+        return TypeValueOrderUnchecked(a, b) < 0;
+      }
+    );
+
+    Set sorted;
+
+    for (Value& element: elements) {
+      auto sz = sorted.values.size();
+
+      if (
+        sz != 0ul &&
+        TypeValueOrderUnchecked(sorted.values[sz - 1ul], element) == 0
+      ) {
+        continue;
+      }
+
+      sorted.values.push_back(std::move(element));
+    }
+
+    if (values.size() == 0ul) {
+      values = std::move(sorted.values);
+      return;
+    }
+
+    combine(sorted, true, true, true);
+  }
+
   bool Set::contains(const Value& element) const {
     if (!element.isFunctionless()) {
       // TODO: Should this be an exception?
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <immer/flex_vector_transient.hpp>
 
 #include "Value.hpp"
@@ -29,6 +31,7 @@ namespace Vortex {
     void subtract(const Set& right);
 
     void insert(Value&& element);
+    void bulkInsert(std::vector<Value>&& elements);
 
     bool contains(const Value& element) const;
   };
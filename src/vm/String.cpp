@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include <immer/algorithm.hpp>
+
+#include "String.hpp"
+
+namespace Vortex {
+  bool IsContinuationByte(char c) {
+    return ((unsigned char)c & 0xc0) == 0x80;
+  }
+
+  String::String(immer::flex_vector<char> chars):
+    immer::flex_vector<char>(std::move(chars)) {}
+
+  String::String(const String& other):
+    immer::flex_vector<char>(other),
+    codePoints(std::atomic_load(&other.codePoints)) {}
+
+  String& String::operator=(const String& other) {
+    immer::flex_vector<char>::operator=(other);
+    std::atomic_store(&codePoints, std::atomic_load(&other.codePoints));
+    return *this;
+  }
+
+  const String::CodePointIndex& String::publish(
+    std::shared_ptr<const CodePointIndex> index
+  ) const {
+    // If another thread published first, its layout is kept and returned
+    std::shared_ptr<const CodePointIndex> expected;
+
+    if (std::atomic_compare_exchange_strong(&codePoints, &expected, index)) {
+      return *index;
+    }
+
+    return *expected;
+  }
+
+  const String::CodePointIndex& String::scanCodePoints() const {
+    auto known = std::atomic_load(&codePoints);
+
+    if (known) {
+      // Once published the layout isn't replaced, so the string keeps it
+      // alive
+      return *known;
+    }
+
+    bool ascii = true;
+
+    immer::for_each_chunk(*this, [&](const char* first, const char* last) {
+      for (; ascii && first != last; ++first) {
+        ascii = ((unsigned char)*first & 0x80) == 0;
+      }
+    });
+
+    static const auto asciiIndex = std::make_shared<const CodePointIndex>(
+      CodePointIndex{.ascii = true, .count = 0ul, .offsets = {}}
+    );
+
+    if (ascii) {
+      return publish(asciiIndex);
+    }
+
+    auto index = std::make_shared<CodePointIndex>();
+    index->ascii = false;
+    index->count = 0ul;
+    Uint64 pos = 0ul;
+
+    immer::for_each_chunk(*this, [&](const char* first, const char* last) {
+      for (; first != last; ++first, ++pos) {
+        if (pos != 0ul && IsContinuationByte(*first)) {
+          continue;
+        }
+
+        if (index->count % CodePointStride == 0ul) {
+          index->offsets.push_back(pos);
+        }
+
+        index->count++;
+      }
+    });
+
+    return publish(std::move(index));
+  }
+
+  Uint64 String::CodePointLength() const {
+    const auto& index = scanCodePoints();
+
+    if (index.ascii) {
+      return size();
+    }
+
+    return index.count;
+  }
+
+  Uint64 String::CodePointOffset(Uint64 i) const {
+    // Byte offset where code point i starts, or size() for the end
+    const auto& index = scanCodePoints();
+
+    if (index.ascii) {
+      return i;
+    }
+
+    if (i >= index.count) {
+      return size();
+    }
+
+    Uint64 pos = index.offsets[i / CodePointStride];
+    auto iter = begin() + pos;
+
+    for (auto skip = i % CodePointStride; skip != 0ul; --skip) {
+      do {
+        ++iter;
+        ++pos;
+      } while (IsContinuationByte(*iter));
+    }
+
+    return pos;
+  }
+
+  String String::CodePointAt(Uint64 i) const {
+    return CodePointSlice(i, i + 1ul);
+  }
+
+  String String::CodePointSlice(Uint64 start, Uint64 end) const {
+    auto startPos = CodePointOffset(start);
+    auto endPos = CodePointOffset(end);
+
+    return take(endPos).drop(startPos);
+  }
+
+  Uint64 StringHash(const String& str) {
+    // 64 bit FNV-1a
+    Uint64 hash = 14695981039346656037ul;
+
+    immer::for_each_chunk(str, [&](const char* first, const char* last) {
+      for (; first != last; ++first) {
+        hash ^= (unsigned char)*first;
+        hash *= 1099511628211ul;
+      }
+    });
+
+    return hash;
+  }
+
+  int StringOrder(const String& left, const String& right) {
+    // Walks the leaves of both strings together and compares them with
+    // memcmp, only dropping to per-char comparison to find the first
+    // difference. The result matches lexContainerOrder with a char
+    // difference comparator.
+    auto leftLen = left.size();
+    auto rightLen = right.size();
+    auto len = std::min(leftLen, rightLen);
+
+    int cmp = 0;
+    Uint64 offset = 0ul;
+
+    immer::for_each_chunk(
+      left.begin(),
+      left.begin() + len,
+      [&](const char* first, const char* last) {
+        if (cmp != 0) {
+          return;
+        }
+
+        auto rightFirst = right.begin() + offset;
+        offset += last - first;
+
+        immer::for_each_chunk(
+          rightFirst,
+          right.begin() + offset,
+          [&](const char* rFirst, const char* rLast) {
+            if (cmp != 0) {
+              return;
+            }
+
+            auto n = rLast - rFirst;
+
+            if (std::memcmp(first, rFirst, n) != 0) {
+              while (*first == *rFirst) {
+                ++first;
+                ++rFirst;
+              }
+
+              cmp = *first - *rFirst;
+              return;
+            }
+
+            first += n;
+          }
+        );
+      }
+    );
+
+    if (cmp != 0) {
+      return cmp;
+    }
+
+    if (leftLen != rightLen) {
+      return leftLen < rightLen ? -1 : 1;
+    }
+
+    return 0;
+  }
+
+  std::string FlattenString(const String& str) {
+    std::string res;
+    res.reserve(str.size());
+
+    immer::for_each_chunk(str, [&](const char* first, const char* last) {
+      res.append(first, last);
+    });
+
+    return res;
+  }
+}
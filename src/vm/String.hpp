@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <immer/flex_vector.hpp>
+
+#include "types.hpp"
+
+namespace Vortex {
+  // Strings hold UTF-8 bytes, and Length, at, hasIndex and Slice count code
+  // points. A code point starts at the first byte and at every later byte
+  // that isn't a continuation byte (10xxxxxx), so malformed input still has
+  // a well defined length.
+  //
+  // The code point layout is found on first use and shared by copies of
+  // the string. ASCII strings share one layout that only marks them as
+  // ASCII. Other strings keep the byte offset of every CodePointStride'th
+  // code point, so finding any code point scans at most one stride.
+  struct String: immer::flex_vector<char> {
+    using immer::flex_vector<char>::flex_vector;
+
+    String() = default;
+    String(immer::flex_vector<char> chars);
+
+    // Copying reads the layout atomically, since another thread may be
+    // publishing it
+    String(const String& other);
+    String(String&& other) = default;
+    String& operator=(const String& other);
+    String& operator=(String&& other) = default;
+
+    static constexpr Uint64 CodePointStride = 64ul;
+
+    struct CodePointIndex {
+      bool ascii;
+      Uint64 count;
+      std::vector<Uint64> offsets;
+    };
+
+    // Only accessed through the std::atomic_* shared_ptr functions. It's
+    // published once, so threads that scan at the same time all end up
+    // with the first layout stored.
+    mutable std::shared_ptr<const CodePointIndex> codePoints;
+
+    const CodePointIndex& publish(std::shared_ptr<const CodePointIndex> index) const;
+    const CodePointIndex& scanCodePoints() const;
+
+    Uint64 CodePointLength() const;
+    Uint64 CodePointOffset(Uint64 i) const;
+    String CodePointAt(Uint64 i) const;
+    String CodePointSlice(Uint64 start, Uint64 end) const;
+  };
+
+  Uint64 StringHash(const String& str);
+  int StringOrder(const String& left, const String& right);
+
+  // Copies the string to contiguous memory a leaf at a time
+  std::string FlattenString(const String& str);
+}
@@ -8,9 +8,11 @@
 #include "Codes.hpp"
 #include "Exceptions.hpp"
 #include "Func.hpp"
-#include "LexOrder.hpp"
+#include "HeapStats.hpp"
+#include "Number.hpp"
 #include "Object.hpp"
 #include "Set.hpp"
+#include "String.hpp"
 #include "types.hpp"
 #include "Value.hpp"
 
@@ -38,13 +40,33 @@ namespace Vortex {
     }
   }
 
+  Uint64 PayloadBytes(Code type) {
+    switch (type) {
+      case STRING: return sizeof(String);
+      case ARRAY: return sizeof(Array);
+      case VSET: return sizeof(Set);
+      case OBJECT: return sizeof(Object);
+      case FUNC: return sizeof(Func);
+
+      default:
+        throw InternalError("Not a payload type");
+    }
+  }
+
   void Value::dealloc() {
     Assert(GetClass(type) == TOP_TYPE || type == INVALID);
 
+    // A move-assigned-from value keeps its type but has no payload
+    if (type >= STRING && type <= FUNC && data.PTR != nullptr) {
+      CountPayloadRelease(type, PayloadBytes(type));
+    }
+
     if (type == ARRAY) {
       delete data.ARRAY;
     } else if (type == STRING) {
       delete data.STRING;
+    } else if (type == VSET) {
+      delete data.SET;
     } else if (type == OBJECT) {
       delete data.OBJECT;
     } else if (type == FUNC) {
@@ -134,26 +156,31 @@ namespace Vortex {
   Value::Value(String* v) {
     type = STRING;
     data.STRING = v;
+    CountPayloadAlloc(type, sizeof(String));
   }
 
   Value::Value(Array* v) {
     type = ARRAY;
     data.ARRAY = v;
+    CountPayloadAlloc(type, sizeof(Array));
   }
 
   Value::Value(Set* v) {
     type = VSET;
     data.SET = v;
+    CountPayloadAlloc(type, sizeof(Set));
   }
 
   Value::Value(Object* v) {
     type = OBJECT;
     data.OBJECT = v;
+    CountPayloadAlloc(type, sizeof(Object));
   }
 
   Value::Value(Func* v) {
     type = FUNC;
     data.FUNC = v;
+    CountPayloadAlloc(type, sizeof(Func));
   }
 
   void Value::copyConstruct(const Value& other) {
@@ -172,7 +199,10 @@ namespace Vortex {
       data.FUNC = new Func(*other.data.FUNC);
     } else {
       data = other.data;
+      return;
     }
+
+    CountPayloadAlloc(type, PayloadBytes(type));
   }
 
   Value::Value(const Value& other) {
@@ -332,13 +362,7 @@ namespace Vortex {
         );
       }
 
-      case STRING: {
-        return lexContainerOrder(
-          *left.data.STRING,
-          *right.data.STRING,
-          [](char a, char b) { return a - b; }
-        );
-      }
+      case STRING: return StringOrder(*left.data.STRING, *right.data.STRING);
 
       case ARRAY: return ArrayValueOrderUnchecked(*left.data.ARRAY, *right.data.ARRAY);
       case VSET: return SetOrder(*left.data.SET, *right.data.SET);
@@ -385,288 +409,8 @@ namespace Vortex {
     right.data = tmpData;
   }
 
-  bool isStringAtomic(const Value& value) {
-    switch (value.type) {
-      case ARRAY:
-      case VSET:
-      case OBJECT:
-        return false;
-
-      default:
-        return true;
-    }
-  }
-
-  template <typename C>
-  bool containsOnlyStringAtomics(const C& container) {
-    for (const auto& v: container) {
-      if (!isStringAtomic(v)) {
-        return false;
-      }
-    }
-
-    return true;
-  }
-
-  std::ostream& StreamKey(std::ostream& os, const Value& key) {
-    if (key.type != STRING) {
-      return os << key;
-    }
-
-    const auto& str = *key.data.STRING;
-    bool first = true;
-    bool validIdentifier = true;
-
-    for (char c: str) {
-      if (first) {
-        if (
-          c == '_' ||
-          ('a' <= c && c <= 'z') ||
-          ('A' <= c && c <= 'Z')
-        ) {
-          first = false;
-          continue;
-        } else {
-          validIdentifier = false;
-          break;
-        }
-      }
-
-      if (!(
-        c == '_' ||
-        ('a' <= c && c <= 'z') ||
-        ('A' <= c && c <= 'Z') ||
-        ('0' <= c && c <= '9')
-      )) {
-        validIdentifier = false;
-        break;
-      }
-    }
-
-    if (!validIdentifier) {
-      return os << key;
-    }
-
-    for (char c: str) {
-      os << c;
-    }
-
-    return os;
-  }
-
-  std::ostream& StreamLongString(
-    std::ostream& os,
-    std::string indent,
-    const Value& value
-  ) {
-    switch (value.type) {
-      case NULL_: {
-        os << "null";
-        break;
-      }
-
-      case BOOL: {
-        if (value.data.BOOL) {
-          os << "true";
-        } else {
-          os << "false";
-        }
-        break;
-      }
-
-      case INT8: {
-        os << (int)value.data.INT8 << "i8";
-        break;
-      }
-
-      case INT16: {
-        os << value.data.INT16 << "i16";
-        break;
-      }
-
-      case INT32: {
-        os << value.data.INT32;
-        break;
-      }
-
-      case INT64: {
-        os << value.data.INT64 << "i64";
-        break;
-      }
-
-      case UINT8: {
-        os << (int)value.data.UINT8 << "u8";
-        break;
-      }
-
-      case UINT16: {
-        os << value.data.UINT16 << "u16";
-        break;
-      }
-
-      case UINT32: {
-        os << value.data.UINT32 << "u32";
-        break;
-      }
-
-      case UINT64: {
-        os << value.data.UINT64 << "u64";
-        break;
-      }
-
-      case FLOAT32: {
-        os << value.data.FLOAT32 << "f32";
-        break;
-      }
-
-      case FLOAT64: {
-        os << value.data.FLOAT64;
-
-        if (value.data.FLOAT64 == std::floor(value.data.FLOAT64)) {
-          os << ".0";
-        }
-
-        break;
-      }
-
-      case ARRAY: {
-        os << '[';
-
-        if (containsOnlyStringAtomics(value.data.ARRAY->values)) {
-          bool notFirst = false;
-
-          for (auto& v: (value.data.ARRAY->values)) {
-            if (notFirst) {
-              os << ", ";
-            }
-
-            os << v;
-            notFirst = true;
-          }
-        } else {
-          os << std::endl;
-
-          for (auto& v: (value.data.ARRAY->values)) {
-            os << indent << "  ";
-            StreamLongString(os, indent + "  ", v);
-            os << ',' << std::endl;
-          }
-
-          os << indent;
-        }
-
-        os << ']';
-
-        break;
-      }
-
-      case VSET: {
-        os << "#[";
-
-        bool notFirst = false;
-
-        if (containsOnlyStringAtomics(value.data.SET->values)) {
-          for (auto& v: (value.data.SET->values)) {
-            if (notFirst) {
-              os << ", ";
-            }
-
-            os << v;
-            notFirst = true;
-          }
-        } else {
-          os << std::endl;
-
-          for (auto& v: (value.data.SET->values)) {
-            os << indent << "  ";
-            StreamLongString(os, indent + "  ", v);
-            os << ',' << std::endl;
-          }
-
-          os << indent;
-        }
-
-        os << ']';
-
-        break;
-      }
-
-      case STRING: {
-        os << '\'';
-
-        for (auto& c: *value.data.STRING) {
-          if (c == '\'') {
-            os << "\\'";
-          } else if (c == '\\') {
-            os << "\\\\";
-          } else {
-            os << c;
-          }
-        }
-
-        os << '\'';
-
-        break;
-      }
-
-      case OBJECT: {
-        os << '{';
-
-        if (containsOnlyStringAtomics(value.data.OBJECT->values.values)) {
-          bool notFirst = false;
-
-          const Object& obj = *value.data.OBJECT;
-          Uint64 sz = obj.keys.Length();
-
-          for (Uint64 pos = 0; pos < sz; pos++) {
-            if (notFirst) {
-              os << ", ";
-            }
-
-            auto key = obj.keys.at(pos);
-            auto value = obj.values.at(pos);
-
-            StreamKey(os, key) << ": " << value;
-            notFirst = true;
-          }
-        } else {
-          os << std::endl;
-
-          const Object& obj = *value.data.OBJECT;
-          Uint64 sz = obj.keys.Length();
-
-          for (Uint64 pos = 0; pos < sz; pos++) {
-            auto key = obj.keys.at(pos);
-            auto value = obj.values.at(pos);
-
-            os << indent << "  ";
-            StreamKey(os, key) << ": ";
-            StreamLongString(os, indent + "  ", value);
-            os << ',' << std::endl;
-          }
-
-          os << indent;
-        }
-
-        os << '}';
-
-        break;
-      }
-
-      case FUNC: {
-        os << "<func>";
-        break;
-      }
-
-      default:
-        throw InternalError("Unrecognized value type");
-    }
-
-    return os;
-  }
-
   std::ostream& operator<<(std::ostream& os, const Value& value) {
-    return StreamLongString(os, "", value);
+    return StreamLongString(os, value);
   }
 
   std::string Value::LongString() {
@@ -745,6 +489,14 @@ namespace Vortex {
       return BuiltInMethod::STRING;
     }
 
+    if (type != FUNC && methodName == "Binary") {
+      return BuiltInMethod::BINARY;
+    }
+
+    if (type != FUNC && methodName == "Json") {
+      return BuiltInMethod::JSON;
+    }
+
     if (type == ARRAY || type == OBJECT) {
       if (methodName == "Keys") {
         return BuiltInMethod::KEYS;
@@ -781,6 +533,16 @@ namespace Vortex {
       if (methodName == "Length") {
         return BuiltInMethod::LENGTH;
       }
+
+      if (methodName == "Slice") {
+        return BuiltInMethod::SLICE;
+      }
+    }
+
+    if (type == STRING) {
+      if (methodName == "ParseJson") {
+        return BuiltInMethod::PARSE_JSON;
+      }
     }
 
     if (type == ARRAY) {
@@ -792,6 +554,10 @@ namespace Vortex {
         return BuiltInMethod::REDUCE;
       }
 
+      if (methodName == "reduceAssoc") {
+        return BuiltInMethod::REDUCE_ASSOC;
+      }
+
       if (methodName == "Front") {
         return BuiltInMethod::FRONT;
       }
@@ -1365,7 +1131,11 @@ namespace Vortex {
         }
 
         case STRING: {
-          *left.data.STRING = *left.data.STRING + std::move(*right.data.STRING);
+          // Moving the lhs lets immer extend its tree in place when it
+          // isn't shared.
+          *left.data.STRING = (
+            std::move(*left.data.STRING) + std::move(*right.data.STRING)
+          );
           return;
         }
 
@@ -1430,13 +1200,13 @@ namespace Vortex {
             }
           }
 
-          if (right.data.UINT64 >= left.data.STRING->size()) {
+          if (right.data.UINT64 >= left.data.STRING->CodePointLength()) {
             throw BadIndexError("Attempt to index past the end of a string");
           }
 
-          left = Value(new String{
-            left.data.STRING->at(right.data.UINT64)
-          });
+          left = Value(new String(
+            left.data.STRING->CodePointAt(right.data.UINT64)
+          ));
 
           return;
         }
@@ -1468,7 +1238,9 @@ namespace Vortex {
             throw TypeError("Tested for non-u64 index of string");
           }
 
-          left = Value(right.data.UINT64 < left.data.STRING->size());
+          left = Value(
+            right.data.UINT64 < left.data.STRING->CodePointLength()
+          );
           return;
         }
 
@@ -1504,18 +1276,14 @@ namespace Vortex {
         throw TypeError("Method names can only be strings");
       }
 
-      auto methodName = std::string(
-        right.data.STRING->begin(),
-        right.data.STRING->end()
-      );
+      auto methodName = FlattenString(*right.data.STRING);
 
       auto method = MethodEnum(left.type, methodName);
 
       Value base;
       swap(base, left);
 
-      left.type = FUNC;
-      left.data.FUNC = new Func();
+      left = Value(new Func());
       left.data.FUNC->method = method;
       left.data.FUNC->binds.push_back(std::move(base));
     }
@@ -1567,18 +1335,14 @@ namespace Vortex {
     void length(Value& value) {
       switch (value.type) {
         case ARRAY: {
-          int len = value.data.ARRAY->Length();
-          delete value.data.ARRAY;
-          value.type = UINT64;
-          value.data.UINT64 = len;
+          Uint64 len = value.data.ARRAY->Length();
+          value = Value(len);
           return;
         }
 
         case STRING: {
-          int len = value.data.STRING->size();
-          delete value.data.STRING;
-          value.type = UINT64;
-          value.data.UINT64 = len;
+          Uint64 len = value.data.STRING->CodePointLength();
+          value = Value(len);
           return;
         }
 
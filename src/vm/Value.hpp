@@ -11,6 +11,7 @@
 
 #include "Codes.hpp"
 #include "Exceptions.hpp"
+#include "String.hpp"
 #include "types.hpp"
 
 namespace Vortex {
@@ -112,6 +113,11 @@ namespace Vortex {
     ROW,
     COLUMN,
     TRANSPOSE,
+    SLICE,
+    BINARY,
+    JSON,
+    PARSE_JSON,
+    REDUCE_ASSOC,
   };
 
   namespace TernaryOperators {
@@ -165,11 +171,7 @@ namespace Vortex {
   bool isNumeric(Code type);
   bool isVector(Code type);
 
-  std::ostream& StreamLongString(
-    std::ostream& os,
-    std::string indent,
-    const Value& value
-  );
+  std::ostream& StreamLongString(std::ostream& os, const Value& value);
 
   int TypeValueOrder(const Value& left, const Value& right);
   int TypeValueOrderUnchecked(const Value& left, const Value& right);
@@ -21,6 +21,7 @@ namespace Vortex {
     {"discard", DISCARD},
     {"guard", GUARD},
     {"unguard", UNGUARD},
+    {"memo", MEMO},
 
     // TOP_TYPE
     //{"", NULL_},
@@ -620,6 +621,7 @@ namespace Vortex {
         break;
       }
 
+      case MEMO:
       case GCALL:
       case MCALL:
       case GET:
@@ -1,11 +1,18 @@
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <immer/flex_vector_transient.hpp>
 
 #include "Array.hpp"
 #include "assemble.hpp"
 #include "frontendUtil.hpp"
+#include "Printer.hpp"
 
 Vortex::Func CodeBlock(std::istream& in) {
   auto bytes = immer::flex_vector_transient<Vortex::byte>();
@@ -51,56 +58,152 @@ Vortex::Value VxArgs(int argc, char** argv) {
       p++;
     }
 
-    args.push_back(Vortex::Value(new immer::flex_vector<char>(arg.persistent())));
+    args.push_back(Vortex::Value(new Vortex::String(arg.persistent())));
   }
 
   return Vortex::Value(new Vortex::Array{.values = std::move(args)});
 }
 
-Vortex::Value LinesFromStream(std::istream& in) {
-  immer::flex_vector_transient<Vortex::Value> lines;
-  immer::flex_vector_transient<char> line;
-
-  while (true) {
-    char c = in.get();
-
-    if (in.eof()) {
-      if (line.size() > 0u) {
-        lines.push_back(Vortex::Value(new immer::flex_vector<char>(line.persistent())));
-        line = immer::flex_vector_transient<char>();
-      }
+void LineSplitter::add(const char* first, const char* last) {
+  while (first != last) {
+    auto nl = static_cast<const char*>(std::memchr(first, '\n', last - first));
 
-      break;
+    if (nl == nullptr) {
+      partial.append(first, last);
+      return;
     }
 
-    if (c == '\n') {
-      lines.push_back(Vortex::Value(new immer::flex_vector<char>(line.persistent())));
-      line = immer::flex_vector_transient<char>();
+    if (partial.empty()) {
+      pushLine(first, nl);
     } else {
-      line.push_back(c);
+      partial.append(first, nl);
+      pushLine(partial.data(), partial.data() + partial.size());
+      partial.clear();
     }
+
+    first = nl + 1;
+  }
+}
+
+Vortex::Value LineSplitter::take() {
+  auto res = Vortex::Value(new Vortex::Array{.values = std::move(lines)});
+  lines = immer::flex_vector_transient<Vortex::Value>();
+
+  return res;
+}
+
+Vortex::Value LineSplitter::finish() {
+  if (!partial.empty()) {
+    pushLine(partial.data(), partial.data() + partial.size());
+    partial.clear();
   }
 
-  return Vortex::Value(new Vortex::Array{.values = std::move(lines)});
+  return take();
+}
+
+void LineSplitter::pushLine(const char* first, const char* last) {
+  lines.push_back(Vortex::Value(new Vortex::String(first, last)));
+}
+
+// Reads lines from a regular file by mapping it. Returns false, having read
+// nothing, for anything that can't be mapped (pipes, terminals, etc).
+bool MappedLines(int fd, Vortex::Value& lines) {
+  struct stat st;
+
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    return false;
+  }
+
+  auto splitter = LineSplitter();
+
+  if (st.st_size == 0) {
+    lines = splitter.finish();
+    return true;
+  }
+
+  auto size = std::size_t(st.st_size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  madvise(data, size, MADV_SEQUENTIAL);
+
+  auto first = static_cast<const char*>(data);
+  splitter.add(first, first + size);
+  lines = splitter.finish();
+
+  munmap(data, size);
+
+  return true;
+}
+
+Vortex::Value LinesFromStream(std::istream& in) {
+  auto splitter = LineSplitter();
+  char buf[1 << 16];
+
+  while (in.read(buf, sizeof(buf)) || in.gcount() > 0) {
+    splitter.add(buf, buf + in.gcount());
+  }
+
+  return splitter.finish();
+}
+
+Vortex::Value LinesFromFile(const std::string& fname) {
+  int fd = open(fname.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    return Vortex::Value(Vortex::Value::null());
+  }
+
+  Vortex::Value lines;
+  bool mapped = MappedLines(fd, lines);
+  close(fd);
+
+  if (mapped) {
+    return lines;
+  }
+
+  std::ifstream ifs(fname.c_str());
+
+  if (!ifs.is_open()) {
+    return Vortex::Value(Vortex::Value::null());
+  }
+
+  return LinesFromStream(ifs);
+}
+
+Vortex::Value LinesFromStdin() {
+  Vortex::Value lines;
+
+  if (MappedLines(STDIN_FILENO, lines)) {
+    return lines;
+  }
+
+  return LinesFromStream(std::cin);
 }
 
 void vxPrint(const Vortex::Value& value) {
+  auto printer = Vortex::Printer(std::cout);
+
   if (value.type == Vortex::STRING) {
-    for (char c: *value.data.STRING) {
-      std::cout << c;
-    }
+    printer.printRaw(*value.data.STRING);
   } else if (value.type == Vortex::ARRAY) {
     for (const auto& v: value.data.ARRAY->values) {
       if (v.type == Vortex::STRING) {
-        for (char c: *v.data.STRING) {
-          std::cout << c;
-        }
-        std::cout << std::endl;
+        printer.printRaw(*v.data.STRING);
       } else {
-        StreamLongString(std::cout, "", v) << std::endl;
+        printer.print(v);
       }
+
+      printer.put('\n');
     }
   } else {
-    StreamLongString(std::cout, "", value) << std::endl;
+    printer.print(value);
+    printer.put('\n');
   }
+
+  printer.flush();
+  std::cout.flush();
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <istream>
+#include <string>
+
+#include <immer/flex_vector_transient.hpp>
 
 #include "Func.hpp"
 #include "Value.hpp"
@@ -9,5 +12,31 @@ Vortex::Func CodeBlock(std::istream& in);
 Vortex::Func assembleCodeBlock(std::istream& in);
 Vortex::Func FileCodeBlock(char* fname);
 Vortex::Value VxArgs(int argc, char** argv);
+
+// Splits input at each '\n' into strings as it arrives. A final line
+// without a newline is kept by finish() unless it is empty.
+class LineSplitter {
+public:
+  void add(const char* first, const char* last);
+
+  // Returns the complete lines added since the last take as an array
+  Vortex::Value take();
+
+  // Returns the remaining lines, including the unterminated one
+  Vortex::Value finish();
+
+private:
+  void pushLine(const char* first, const char* last);
+
+  immer::flex_vector_transient<Vortex::Value> lines;
+  std::string partial;
+};
+
 Vortex::Value LinesFromStream(std::istream& in);
+
+// Returns null if the file can't be opened. Regular files are mapped rather
+// than read through a stream, and so is stdin when it's redirected from one.
+Vortex::Value LinesFromFile(const std::string& fname);
+Vortex::Value LinesFromStdin();
+
 void vxPrint(const Vortex::Value& value);
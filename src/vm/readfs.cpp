@@ -1,20 +1,48 @@
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <iostream>
-#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "readfs.hpp"
 
 #include "Array.hpp"
 #include "frontendUtil.hpp"
 #include "Machine.hpp"
+#include "String.hpp"
 
 bool isOutputRequest(const Vortex::Value& request);
 void outputRequest(const Vortex::Value& request);
 bool isReadRequest(const Vortex::Value& request);
-Vortex::Value readRequest(const std::string& root, const Vortex::Value& request);
+std::string readPath(const std::string& root, const Vortex::Value& request);
+
+using ReadCache = std::unordered_map<std::string, Vortex::Value>;
+void readFiles(const std::vector<std::string>& paths, ReadCache& cache);
+
+// Reads are IO bound, so this isn't tied to the number of cores
+constexpr Vortex::Uint64 ReadThreads = 16ul;
+
+constexpr int DefaultMaxIterations = 1000;
 
 int readfs(int argc, char** argv) {
-  if (argc < 3) {
-    std::cerr << "Usage: vxvm readfs <root-dir> <program> [...args]" << std::endl;
+  // 0 means no limit
+  int maxIterations = DefaultMaxIterations;
+
+  if (argc >= 3 && std::string(argv[1]) == "--max-iterations") {
+    try {
+      maxIterations = std::stoi(argv[2]);
+    } catch (const std::exception&) {
+      maxIterations = -1;
+    }
+
+    argc -= 2;
+    argv += 2;
+  }
+
+  if (argc < 3 || maxIterations < 0) {
+    std::cerr << "Usage: vxvm readfs [--max-iterations <n>] <root-dir> <program> [...args]" << std::endl;
     return 1;
   }
 
@@ -32,13 +60,15 @@ int readfs(int argc, char** argv) {
 
   auto init = Vortex::Value(new Vortex::Array());
   init.data.ARRAY->pushBack(Vortex::Value(new Vortex::String{'i', 'n', 'i', 't'}));
-  init.data.ARRAY->pushBack(Vortex::Value(args));
+  init.data.ARRAY->pushBack(std::move(args));
   auto actions = Vortex::Value(new Vortex::Array());
-  actions.data.ARRAY->pushBack(Vortex::Value(init));
-  machine.push(actions);
+  actions.data.ARRAY->pushBack(std::move(init));
+  machine.push(std::move(actions));
 
   machine.push(Vortex::Value(Vortex::Value::null())); // state
 
+  // Files are read at most once per session, keyed by path
+  auto cache = ReadCache();
   int iterations = 0;
 
   while (true) {
@@ -54,18 +84,25 @@ int readfs(int argc, char** argv) {
       return 1;
     }
 
+    // Nothing else refers to the output, so its parts are moved out instead
+    // of copied, which would otherwise copy the whole state every iteration.
+
     // Second element is an array of things to do
-    auto requests = output.data.ARRAY->at(1);
+    auto requests = output.data.ARRAY->extract(1);
 
     if (requests.type != Vortex::ARRAY) {
       std::cerr << "Expected requests to be an array" << std::endl;
       return 1;
     }
 
-    auto replies = Vortex::Value(new Vortex::Array());
+    // Reads have no side effects, so the batch is checked first and then
+    // its reads are done together. An empty path stands for a read outside
+    // the root, which gets null.
+    std::vector<std::string> paths;
+    auto len = requests.data.ARRAY->Length();
 
-    for (int i = 0; i < requests.data.ARRAY->Length(); i++) {
-      auto request = requests.data.ARRAY->at(i);
+    for (auto i = 0ul; i != len; ++i) {
+      const auto& request = requests.data.ARRAY->values[i];
 
       if (isOutputRequest(request)) {
         outputRequest(request);
@@ -73,7 +110,7 @@ int readfs(int argc, char** argv) {
       }
 
       if (isReadRequest(request)) {
-        replies.data.ARRAY->pushBack(readRequest(root, request));
+        paths.push_back(readPath(root, request));
         continue;
       }
 
@@ -81,17 +118,29 @@ int readfs(int argc, char** argv) {
       return 1;
     }
 
+    readFiles(paths, cache);
+
+    auto replies = Vortex::Value(new Vortex::Array());
+
+    for (const auto& path: paths) {
+      if (path.empty()) {
+        replies.data.ARRAY->pushBack(Vortex::Value(Vortex::Value::null()));
+      } else {
+        replies.data.ARRAY->pushBack(Vortex::Value(cache.at(path)));
+      }
+    }
+
     iterations++;
 
-    if (iterations >= 1000) {
-      std::cerr << "Reached 1000 iterations limit" << std::endl;
+    if (iterations == maxIterations) {
+      std::cerr << "Reached " << maxIterations << " iterations limit" << std::endl;
       return 1;
     }
 
-    machine.push(replies);
+    machine.push(std::move(replies));
 
     // First element is the new state
-    machine.push(output.data.ARRAY->at(0));
+    machine.push(output.data.ARRAY->extract(0));
   }
 }
 
@@ -106,10 +155,7 @@ bool isOutputRequest(const Vortex::Value& request) {
 
   Vortex::Value vxActionType = request.data.ARRAY->at(0);
 
-  std::string actionType(
-    vxActionType.data.STRING->begin(),
-    vxActionType.data.STRING->end()
-  );
+  auto actionType = Vortex::FlattenString(*vxActionType.data.STRING);
 
   return actionType == "output";
 }
@@ -132,16 +178,13 @@ bool isReadRequest(const Vortex::Value& request) {
 
   Vortex::Value vxActionType = request.data.ARRAY->at(0);
 
-  std::string actionType(
-    vxActionType.data.STRING->begin(),
-    vxActionType.data.STRING->end()
-  );
+  auto actionType = Vortex::FlattenString(*vxActionType.data.STRING);
 
   return actionType == "read";
 }
 
-Vortex::Value readRequest(const std::string& root, const Vortex::Value& request) {
-  auto vxFname = request.data.ARRAY->at(1);
+std::string readPath(const std::string& root, const Vortex::Value& request) {
+  const auto& vxFname = request.data.ARRAY->values[1];
 
   // Prevent reading outside root dir by disallowing '..'
   bool prevDot = false;
@@ -150,19 +193,49 @@ Vortex::Value readRequest(const std::string& root, const Vortex::Value& request)
     bool dot = c == '.';
 
     if (dot && prevDot) {
-      return Vortex::Value(Vortex::Value::null());
+      return "";
     }
 
     prevDot = dot;
   }
 
-  auto fname = root + '/' + std::string(vxFname.data.STRING->begin(), vxFname.data.STRING->end());
+  return root + '/' + Vortex::FlattenString(*vxFname.data.STRING);
+}
 
-  std::ifstream ifs(fname.c_str());
+void readFiles(const std::vector<std::string>& paths, ReadCache& cache) {
+  std::vector<std::string> pending;
 
-  if (!ifs.is_open()) {
-    return Vortex::Value(Vortex::Value::null());
+  for (const auto& path: paths) {
+    if (!path.empty() && cache.count(path) == 0) {
+      cache.emplace(path, Vortex::Value(Vortex::Value::null()));
+      pending.push_back(path);
+    }
   }
 
-  return LinesFromStream(ifs);
+  // Each worker takes the next unread path until there are none left
+  std::vector<Vortex::Value> results(pending.size());
+  std::atomic<std::size_t> next(0);
+
+  auto work = [&]() {
+    for (auto i = next++; i < pending.size(); i = next++) {
+      results[i] = LinesFromFile(pending[i]);
+    }
+  };
+
+  auto threads = std::min(Vortex::Uint64(pending.size()), ReadThreads);
+  std::vector<std::future<void>> workers;
+
+  for (auto i = 1ul; i < threads; ++i) {
+    workers.push_back(std::async(std::launch::async, work));
+  }
+
+  work();
+
+  for (auto& worker: workers) {
+    worker.get();
+  }
+
+  for (auto i = 0ul; i != pending.size(); ++i) {
+    cache[pending[i]] = std::move(results[i]);
+  }
 }
@@ -1,9 +1,19 @@
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include <immer/algorithm.hpp>
 #include <immer/flex_vector_transient.hpp>
 
 #include "Array.hpp"
+#include "Binary.hpp"
+#include "Json.hpp"
 #include "Exceptions.hpp"
 #include "Machine.hpp"
+#include "Number.hpp"
 #include "Object.hpp"
+#include "Parallel.hpp"
 #include "runBuiltInMethod.hpp"
 
 namespace Vortex {
@@ -15,6 +25,24 @@ namespace Vortex {
   void TransposeObjectArray(Value& object);
   void TransposeObjectObject(Object& object);
 
+  Uint64 SliceBound(const Value& bound);
+
+  immer::flex_vector_transient<Value> MapValues(
+    Machine& machine,
+    const Value& fn,
+    const Array& arr
+  );
+
+  void FoldRange(
+    Machine& machine,
+    const Value& fn,
+    const Array& arr,
+    Uint64 first,
+    Uint64 last
+  );
+
+  void ReduceAssociative(Machine& machine, const Value& fn, const Array& arr);
+
   void runBuiltInMethod(Machine& machine, BuiltInMethod method) {
     switch (method) {
       case BuiltInMethod::NONE:
@@ -26,7 +54,7 @@ namespace Vortex {
 
         switch (base.type) {
           case ARRAY: base = Value(base.data.ARRAY->Length()); return;
-          case STRING: base = Value(base.data.STRING->size()); return;
+          case STRING: base = Value(base.data.STRING->CodePointLength()); return;
 
           default:
             throw InternalError("Invalid base type");
@@ -136,6 +164,48 @@ namespace Vortex {
         return;
       }
 
+      case BuiltInMethod::BINARY: {
+        Assert(!machine.calc.empty());
+        auto& base = machine.calc.back();
+
+        std::string bytes;
+        EncodeBinary(bytes, base);
+
+        // A u8 array rather than a string, whose Length and indexes count
+        // code points rather than bytes
+        immer::flex_vector_transient<Value> out;
+
+        for (char b: bytes) {
+          out.push_back(Value((Uint8)b));
+        }
+
+        base = Value(new Array{.values = std::move(out)});
+        return;
+      }
+
+      case BuiltInMethod::JSON: {
+        Assert(!machine.calc.empty());
+        auto& base = machine.calc.back();
+
+        std::string text;
+        EncodeJson(text, base);
+        base = Value(new String(text.begin(), text.end()));
+        return;
+      }
+
+      case BuiltInMethod::PARSE_JSON: {
+        Assert(!machine.calc.empty());
+        auto& base = machine.calc.back();
+
+        if (base.type != STRING) {
+          throw InternalError("Invalid base type");
+        }
+
+        auto text = FlattenString(*base.data.STRING);
+        base = ParseJson(text.data(), text.data() + text.size());
+        return;
+      }
+
       case BuiltInMethod::KIND: {
         Assert(!machine.calc.empty());
         auto& base = machine.calc.back();
@@ -184,14 +254,7 @@ namespace Vortex {
           throw InternalError("Invalid map argument");
         }
 
-        auto items = immer::flex_vector_transient<Value>();
-
-        for (const Value& v: base.data.ARRAY->values) {
-          machine.calc.push_back(v);
-          machine.call(fn);
-          items.push_back(machine.pop());
-        }
-
+        auto items = MapValues(machine, fn, *base.data.ARRAY);
         machine.calc.push_back(Value(new Array{.values = std::move(items)}));
         return;
       }
@@ -210,22 +273,24 @@ namespace Vortex {
           throw InternalError("Invalid reduce argument");
         }
 
-        bool first = true;
+        FoldRange(machine, fn, *base.data.ARRAY, 0ul, base.data.ARRAY->Length());
+        return;
+      }
 
-        for (const Value& v: base.data.ARRAY->values) {
-          machine.calc.push_back(v);
+      case BuiltInMethod::REDUCE_ASSOC: {
+        auto base = machine.pop();
 
-          if (first) {
-            first = false;
-            continue;
-          }
+        if (base.type != ARRAY) {
+          throw InternalError("Invalid base type");
+        }
 
-          auto p = machine.BackPair();
-          swap(*p.first, *p.second);
+        auto fn = machine.pop();
 
-          machine.call(fn);
+        if (fn.type != FUNC) {
+          throw InternalError("Invalid reduceAssoc argument");
         }
 
+        ReduceAssociative(machine, fn, *base.data.ARRAY);
         return;
       }
 
@@ -334,6 +399,44 @@ namespace Vortex {
             throw InternalError("Invalid base type");
         }
       }
+
+      case BuiltInMethod::SLICE: {
+        auto base = machine.pop();
+        auto start = SliceBound(machine.pop());
+        auto end = SliceBound(machine.pop());
+
+        Uint64 len = (
+          base.type == STRING ?
+          base.data.STRING->CodePointLength() :
+          base.data.ARRAY->Length()
+        );
+
+        if (start > end || end > len) {
+          throw BadIndexError("Slice out of range");
+        }
+
+        // Both cases keep the nodes of the original that overlap the slice
+        switch (base.type) {
+          case STRING: {
+            auto& str = *base.data.STRING;
+            str = str.CodePointSlice(start, end);
+            break;
+          }
+
+          case ARRAY: {
+            auto& values = base.data.ARRAY->values;
+            values.take(end);
+            values.drop(start);
+            break;
+          }
+
+          default:
+            throw InternalError("Invalid base type");
+        }
+
+        machine.calc.push_back(std::move(base));
+        return;
+      }
     }
   }
 
@@ -349,164 +452,410 @@ namespace Vortex {
     array.values = std::move(items);
   }
 
-  void TransposeArrayArray(Array& array) {
-    auto len = array.Length();
-    auto innerLength = array.InnerLength();
+  // Transpose works from a row-major buffer of the table's cells and emits
+  // the result in tiles of TransposeTile columns. Each pass over the buffer
+  // then reads a short contiguous run from every row rather than striding
+  // through the whole table once per output row.
+  const Uint64 TransposeTile = 32ul;
 
-    auto items = immer::flex_vector_transient<Value>();
+  void PushRowCells(std::vector<Value>& cells, Array& row) {
+    bool numeric = true;
 
-    for (auto i = 0ul; i != innerLength; ++i) {
-      auto row = immer::flex_vector_transient<Value>();
-
-      for (auto j = 0ul; j != len; ++j) {
-        row.push_back(array.values[j].data.ARRAY->values[i]);
+    for (const Value& v: row.values) {
+      if (!isNumeric(v.type)) {
+        numeric = false;
+        break;
       }
+    }
 
-      items.push_back(Value(new Array{.values = std::move(row)}));
+    if (numeric) {
+      // Numbers have no heap payload, so the whole row can be copied in bulk.
+      cells.insert(cells.end(), row.values.begin(), row.values.end());
+      return;
     }
 
-    array.values = std::move(items);
+    auto len = row.Length();
+
+    for (auto i = 0ul; i != len; ++i) {
+      // immer only copies the leaf if it is shared, so elements of a uniquely
+      // owned row are moved out without copying their payloads.
+      row.values.update(i, [&](Value&& v) {
+        cells.push_back(std::move(v));
+        return Value();
+      });
+    }
   }
 
-  void TransposeObjectArray(Value& object) {
-    Object& obj = *object.data.OBJECT;
-    auto len = obj.keys.Length();
-    auto innerLength = obj.InnerLength();
+  std::vector<Value> TableCells(Array& table, Uint64 innerLength) {
+    auto len = table.Length();
+
+    std::vector<Value> cells;
+    cells.reserve(len * innerLength);
 
+    for (auto j = 0ul; j != len; ++j) {
+      table.values.update(j, [&](Value&& row) {
+        PushRowCells(
+          cells,
+          row.type == ARRAY ? *row.data.ARRAY : row.data.OBJECT->values
+        );
+
+        return Value();
+      });
+    }
+
+    return cells;
+  }
+
+  template <typename MakeRow>
+  immer::flex_vector_transient<Value> TransposeCells(
+    std::vector<Value>& cells,
+    Uint64 len,
+    Uint64 innerLength,
+    MakeRow makeRow
+  ) {
     auto items = immer::flex_vector_transient<Value>();
+    std::vector<immer::flex_vector_transient<Value>> tile;
 
-    for (auto i = 0ul; i != innerLength; ++i) {
-      auto row = immer::flex_vector_transient<Value>();
+    for (auto start = 0ul; start < innerLength; start += TransposeTile) {
+      auto width = std::min(TransposeTile, innerLength - start);
+      tile.assign(width, immer::flex_vector_transient<Value>());
 
       for (auto j = 0ul; j != len; ++j) {
-        row.push_back(obj.values.values[j].data.ARRAY->values[i]);
+        Value* run = &cells[j * innerLength + start];
+
+        for (auto i = 0ul; i != width; ++i) {
+          tile[i].push_back(std::move(run[i]));
+        }
       }
 
-      items.push_back(Value(new Object{
-        .keys = obj.keys,
-        .values = Array{.values = std::move(row)},
-      }));
+      for (auto& row: tile) {
+        items.push_back(makeRow(std::move(row)));
+      }
     }
 
+    return items;
+  }
+
+  void TransposeArrayArray(Array& array) {
+    auto len = array.Length();
+    auto innerLength = array.InnerLength();
+    auto cells = TableCells(array, innerLength);
+
+    array.values = TransposeCells(
+      cells,
+      len,
+      innerLength,
+      [](immer::flex_vector_transient<Value>&& row) {
+        return Value(new Array{.values = std::move(row)});
+      }
+    );
+  }
+
+  void TransposeObjectArray(Value& object) {
+    Object& obj = *object.data.OBJECT;
+    auto len = obj.keys.Length();
+    auto innerLength = obj.InnerLength();
+    auto cells = TableCells(obj.values, innerLength);
+
+    // Every row has obj's keys, so they share its keys and index
+    auto proto = Object{
+      .keys = obj.keys,
+      .index = obj.index,
+      .indexed = obj.indexed,
+    };
+
+    auto items = TransposeCells(
+      cells,
+      len,
+      innerLength,
+      [&](immer::flex_vector_transient<Value>&& row) {
+        auto res = Value(new Object(proto));
+        res.data.OBJECT->values = Array{.values = std::move(row)};
+        return res;
+      }
+    );
+
     object = Value(new Array{.values = std::move(items)});
   }
 
   void TransposeArrayObject(Value& array) {
     Array& arr = *array.data.ARRAY;
     auto len = arr.Length();
-    auto innerLength = arr.InnerKeys().Length();
-    auto keys = arr.values[0].data.OBJECT->keys;
-
-    auto items = immer::flex_vector_transient<Value>();
+    auto keys = arr.InnerKeys();
+    auto innerLength = keys.Length();
+    auto cells = TableCells(arr, innerLength);
 
-    for (auto i = 0ul; i != innerLength; ++i) {
-      auto row = immer::flex_vector_transient<Value>();
-
-      for (auto j = 0ul; j != len; ++j) {
-        row.push_back(arr.values[j].data.OBJECT->values.values[i]);
+    auto items = TransposeCells(
+      cells,
+      len,
+      innerLength,
+      [](immer::flex_vector_transient<Value>&& row) {
+        return Value(new Array{.values = std::move(row)});
       }
-
-      items.push_back(Value(new Array{
-        .values = std::move(row),
-      }));
-    }
+    );
 
     array = Value(new Object{
       .keys = std::move(keys),
       .values = Array{.values = std::move(items)}
     });
+
+    array.data.OBJECT->reindex();
   }
 
   void TransposeObjectObject(Object& object) {
     auto len = object.keys.Length();
-    auto innerLength = object.InnerKeys().Length();
+    auto innerKeys = object.InnerKeys();
+    auto innerLength = innerKeys.Length();
+    auto cells = TableCells(object.values, innerLength);
+
+    auto proto = Object{
+      .keys = object.keys,
+      .index = object.index,
+      .indexed = object.indexed,
+    };
+
+    auto items = TransposeCells(
+      cells,
+      len,
+      innerLength,
+      [&](immer::flex_vector_transient<Value>&& row) {
+        auto res = Value(new Object(proto));
+        res.data.OBJECT->values = Array{.values = std::move(row)};
+        return res;
+      }
+    );
 
-    auto items = immer::flex_vector_transient<Value>();
+    object = Object{
+      .keys = std::move(innerKeys),
+      .values = Array{.values = std::move(items)},
+    };
 
-    for (auto i = 0ul; i != innerLength; ++i) {
-      auto row = immer::flex_vector_transient<Value>();
+    object.reindex();
+  }
 
-      for (auto j = 0ul; j != len; ++j) {
-        row.push_back(object.values.values[j].data.OBJECT->values.values[i]);
+  Uint64 SliceBound(const Value& bound) {
+    if (bound.type == UINT64) {
+      return bound.data.UINT64;
+    }
+
+    if (bound.type == INT32 && bound.data.INT32 >= 0) {
+      return bound.data.INT32;
+    }
+
+    throw TypeError("Slice bounds must be u64 or non-negative i32");
+  }
+
+  // Arrays from this length are mapped or reduced across threads. Below
+  // it, starting workers costs more than it saves for typical functions.
+  const Uint64 ParallelArraySize = 1ul << 12;
+
+  // Chunks are small enough that workers finishing early can take more of
+  // the work, but not so small that fetching them dominates.
+  const Uint64 ChunksPerThread = 8ul;
+  const Uint64 MinChunk = 256ul;
+
+  // Splits len elements into chunks and runs runChunk(worker, k, first,
+  // last) for each, on forks of machine across the configured threads.
+  // Workers take chunks in order from a shared counter. Returns the index
+  // of the first chunk that threw, or the chunk count if none did, after
+  // which later chunks may not have run.
+  template <typename RunChunk>
+  Uint64 RunChunks(Machine& machine, Uint64 len, Uint64 chunkSize, RunChunk runChunk) {
+    auto chunks = (len + chunkSize - 1ul) / chunkSize;
+    std::atomic<Uint64> next(0ul);
+    std::atomic<Uint64> firstFailure(chunks);
+
+    auto work = [&]() {
+      auto worker = machine.fork();
+
+      for (auto k = next++; k < chunks; k = next++) {
+        // Nothing after a failure is used
+        if (k > firstFailure.load()) {
+          break;
+        }
+
+        try {
+          auto first = k * chunkSize;
+          runChunk(worker, k, first, std::min(len, first + chunkSize));
+        } catch (...) {
+          auto prev = firstFailure.load();
+
+          while (k < prev && !firstFailure.compare_exchange_weak(prev, k)) {}
+
+          // The worker's stack is left as it was when the function threw
+          worker = machine.fork();
+        }
       }
+    };
+
+    std::vector<std::future<void>> workers;
+
+    for (auto i = 1ul; i < std::min(ThreadCount(), chunks); ++i) {
+      workers.push_back(std::async(std::launch::async, work));
+    }
+
+    work();
 
-      items.push_back(Value(new Object{
-        .keys = object.keys,
-        .values = Array{.values = std::move(row)},
-      }));
+    for (auto& w: workers) {
+      w.get();
     }
 
-    object.keys = object.values.values[0].data.OBJECT->keys;
-    object.values.values = std::move(items);
+    return firstFailure.load();
   }
 
-  template <typename T>
-  String toStreamString(const T& value) {
-    std::ostringstream oss;
-    oss << value;
-    std::string s = oss.str();
+  bool UseParallel(const Machine& machine, Uint64 len) {
+    // Workers don't start workers of their own, which would oversubscribe
+    // the threads
+    return ThreadCount() >= 2ul && len >= ParallelArraySize && !machine.worker;
+  }
 
-    return String(s.begin(), s.end());
+  Uint64 ChunkSize(Uint64 len) {
+    return std::max(MinChunk, len / (ThreadCount() * ChunksPerThread));
   }
 
-  String toString(const Value& value) {
-    switch (value.type) {
-      case NULL_: {
-        return {'n', 'u', 'l', 'l'};
-      }
+  void MapRange(
+    Machine& machine,
+    const Value& fn,
+    const Array& arr,
+    Uint64 first,
+    Uint64 last,
+    immer::flex_vector_transient<Value>& out
+  ) {
+    for (auto i = first; i != last; ++i) {
+      machine.calc.push_back(arr.values[i]);
+      machine.call(fn);
+      out.push_back(machine.pop());
+    }
+  }
 
-      case BOOL: {
-        if (value.data.BOOL) {
-          return {'t', 'r', 'u', 'e'};
-        }
+  // Vortex functions are pure, so elements can be mapped in any order on
+  // any machine. The chunk results are concatenated. If a chunk fails, the
+  // results before it are kept and the rest is mapped again on this
+  // machine, so the first failing element throws as it would sequentially.
+  immer::flex_vector_transient<Value> MapValues(
+    Machine& machine,
+    const Value& fn,
+    const Array& arr
+  ) {
+    auto len = arr.Length();
+    immer::flex_vector_transient<Value> out;
 
-        return {'f', 'a', 'l', 's', 'e'};
-      }
+    if (!UseParallel(machine, len)) {
+      MapRange(machine, fn, arr, 0ul, len, out);
+      return out;
+    }
 
-      case INT8: {
-        return toStreamString((int)value.data.INT8) + String{'i', '8'};
-      }
+    auto chunkSize = ChunkSize(len);
+    std::vector<immer::flex_vector_transient<Value>> results((len + chunkSize - 1ul) / chunkSize);
 
-      case INT16: {
-        return toStreamString((int)value.data.INT16) + String{'i', '1', '6'};
+    auto done = RunChunks(
+      machine,
+      len,
+      chunkSize,
+      [&](Machine& worker, Uint64 k, Uint64 first, Uint64 last) {
+        MapRange(worker, fn, arr, first, last, results[k]);
       }
+    );
 
-      case INT32: {
-        return toStreamString(value.data.INT32);
-      }
+    for (auto k = 0ul; k != done; ++k) {
+      out.append(std::move(results[k]));
+    }
 
-      case INT64: {
-        return toStreamString(value.data.INT64) + String{'i', '6', '4'};
-      }
+    if (done != results.size()) {
+      MapRange(machine, fn, arr, done * chunkSize, len, out);
+    }
 
-      case UINT8: {
-        return toStreamString((int)value.data.UINT8) + String{'u', '8'};
-      }
+    return out;
+  }
 
-      case UINT16: {
-        return toStreamString((int)value.data.UINT16) + String{'u', '1', '6'};
-      }
+  // Folds arr[first, last) left to right with fn, leaving the result on
+  // the machine's stack. Nothing is left for an empty range.
+  void FoldRange(
+    Machine& machine,
+    const Value& fn,
+    const Array& arr,
+    Uint64 first,
+    Uint64 last
+  ) {
+    for (auto i = first; i != last; ++i) {
+      machine.calc.push_back(arr.values[i]);
 
-      case UINT32: {
-        return toStreamString(value.data.UINT32) + String{'u', '3', '2'};
+      if (i == first) {
+        continue;
       }
 
-      case UINT64: {
-        return toStreamString(value.data.UINT64) + String{'u', '6', '4'};
-      }
+      auto p = machine.BackPair();
+      swap(*p.first, *p.second);
+
+      machine.call(fn);
+    }
+  }
+
+  // Tree reduction for :reduceAssoc. With an associative fn, folding each
+  // chunk on a worker and then folding the chunk results in order gives
+  // the same value as folding everything left to right. If any chunk
+  // fails, the whole array is folded again on this machine so the error
+  // is the sequential one.
+  void ReduceAssociative(Machine& machine, const Value& fn, const Array& arr) {
+    auto len = arr.Length();
 
-      case FLOAT32: {
-        return toStreamString(value.data.FLOAT32) + String{'f', '3', '2'};
+    if (!UseParallel(machine, len)) {
+      FoldRange(machine, fn, arr, 0ul, len);
+      return;
+    }
+
+    auto chunkSize = ChunkSize(len);
+    auto partials = Array();
+    std::vector<Value> results((len + chunkSize - 1ul) / chunkSize);
+
+    auto done = RunChunks(
+      machine,
+      len,
+      chunkSize,
+      [&](Machine& worker, Uint64 k, Uint64 first, Uint64 last) {
+        FoldRange(worker, fn, arr, first, last);
+        results[k] = worker.pop();
       }
+    );
 
-      case FLOAT64: {
-        auto res = toStreamString(value.data.FLOAT64);
+    if (done != results.size()) {
+      FoldRange(machine, fn, arr, 0ul, len);
+      return;
+    }
 
-        if (value.data.FLOAT64 == std::floor(value.data.FLOAT64)) {
-          res = res + String{'.', '0'};
+    for (auto& result: results) {
+      partials.pushBack(std::move(result));
+    }
+
+    FoldRange(machine, fn, partials, 0ul, partials.Length());
+  }
+
+  String toString(const Value& value) {
+    switch (value.type) {
+      case NULL_: {
+        return {'n', 'u', 'l', 'l'};
+      }
+
+      case BOOL: {
+        if (value.data.BOOL) {
+          return {'t', 'r', 'u', 'e'};
         }
 
-        return res;
+        return {'f', 'a', 'l', 's', 'e'};
+      }
+
+      case INT8:
+      case INT16:
+      case INT32:
+      case INT64:
+      case UINT8:
+      case UINT16:
+      case UINT32:
+      case UINT64:
+      case FLOAT32:
+      case FLOAT64: {
+        char buf[NumberBufferSize];
+        return String(buf, WriteNumber(buf, value));
       }
 
       case ARRAY: {
@@ -516,14 +865,14 @@ namespace Vortex {
 
         for (auto& v: value.data.ARRAY->values) {
           if (notFirst) {
-            res = res.push_back(',');
+            res = std::move(res).push_back(',');
           }
 
-          res = res + toString(v);
+          res = std::move(res) + toString(v);
           notFirst = true;
         }
 
-        res = res.push_back(']');
+        res = std::move(res).push_back(']');
 
         return res;
       }
@@ -535,37 +884,39 @@ namespace Vortex {
 
         for (auto& v: value.data.SET->values) {
           if (notFirst) {
-            res = res.push_back(',');
+            res = std::move(res).push_back(',');
           }
 
-          res = res + toString(v);
+          res = std::move(res) + toString(v);
           notFirst = true;
         }
 
-        res = res.push_back(']');
+        res = std::move(res).push_back(']');
 
         return res;
       }
 
       case STRING: {
+        // Runs without escapes are slices of the original, so they share
+        // its leaves.
+        const auto& str = *value.data.STRING;
         auto res = String{'\''};
-        auto len = value.data.STRING->size();
 
         auto upto = 0ul;
         auto i = 0ul;
 
-        for (; i < len; ++i) {
-          char c = value.data.STRING->at(i);
-
-          if (c == '\'' || c == '\\') {
-            res = res + value.data.STRING->drop(upto).take(i - upto);
-            res = res + String{'\\', c};
-            upto = i + 1ul;
+        immer::for_each_chunk(str, [&](const char* first, const char* last) {
+          for (; first != last; ++first, ++i) {
+            if (*first == '\'' || *first == '\\') {
+              res = std::move(res) + str.drop(upto).take(i - upto);
+              res = std::move(res) + String{'\\', *first};
+              upto = i + 1ul;
+            }
           }
-        }
+        });
 
-        res = res + value.data.STRING->drop(upto).take(i - upto);
-        res = res.push_back('\'');
+        res = std::move(res) + str.drop(upto);
+        res = std::move(res).push_back('\'');
 
         return res;
       }
@@ -580,17 +931,16 @@ namespace Vortex {
 
         for (Uint64 pos = 0; pos < sz; pos++) {
           if (notFirst) {
-            res = res.push_back(',');
+            res = std::move(res).push_back(',');
           }
 
-          auto key = obj.keys.at(pos);
-          auto value = obj.values.at(pos);
-
-          res = res + toString(key) + String{':'} + toString(value);
+          res = std::move(res) + toString(obj.keys.values[pos]);
+          res = std::move(res).push_back(':');
+          res = std::move(res) + toString(obj.values.values[pos]);
           notFirst = true;
         }
 
-        res = res.push_back('}');
+        res = std::move(res).push_back('}');
 
         return res;
       }
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "serve.hpp"
+
+#include "frontendUtil.hpp"
+#include "Json.hpp"
+#include "Machine.hpp"
+#include "Parallel.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct ServeRequest {
+  Vortex::Uint64 seq;
+  std::string line;
+  Clock::time_point received;
+};
+
+// Reading pauses while this many requests are waiting for a worker, so a
+// client that writes faster than requests are served can't queue unbounded
+// input.
+constexpr std::size_t MaxQueuedRequests = 1024ul;
+
+class RequestQueue {
+public:
+  void push(ServeRequest&& request) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [&]() { return requests.size() < MaxQueuedRequests; });
+    requests.push_back(std::move(request));
+    notEmpty.notify_one();
+  }
+
+  // Returns false once the queue is closed and empty
+  bool pop(ServeRequest& request) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notEmpty.wait(lock, [&]() { return !requests.empty() || closed; });
+
+    if (requests.empty()) {
+      return false;
+    }
+
+    request = std::move(requests.front());
+    requests.pop_front();
+    notFull.notify_one();
+
+    return true;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    notEmpty.notify_all();
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable notEmpty;
+  std::condition_variable notFull;
+  std::deque<ServeRequest> requests;
+  bool closed = false;
+};
+
+// Writes responses in request order as they complete, and records how
+// long each request took from being read to being completed.
+class ResponseWriter {
+public:
+  void complete(const ServeRequest& request, std::string&& response, bool error) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      Clock::now() - request.received
+    );
+
+    std::lock_guard<std::mutex> lock(mutex);
+    latencies.push_back(elapsed.count());
+    ready.emplace(request.seq, std::move(response));
+
+    if (error) {
+      errors++;
+    }
+
+    bool wrote = false;
+
+    for (auto iter = ready.begin(); iter != ready.end() && iter->first == next; iter = ready.erase(iter)) {
+      std::cout << iter->second << '\n';
+      wrote = true;
+      next++;
+    }
+
+    if (wrote) {
+      std::cout.flush();
+    }
+  }
+
+  void printStats(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::sort(latencies.begin(), latencies.end());
+
+    auto count = latencies.size();
+
+    auto percentile = [&](std::size_t p) -> Vortex::Uint64 {
+      return count == 0ul ? 0ul : latencies[std::min(count - 1ul, count * p / 100ul)];
+    };
+
+    Vortex::Uint64 total = 0ul;
+
+    for (auto latency: latencies) {
+      total += latency;
+    }
+
+    os << std::left << std::setw(10) << "requests" << std::right;
+    os << std::setw(10) << "errors";
+
+    for (auto name: {"mean us", "p50 us", "p90 us", "p99 us", "max us"}) {
+      os << std::setw(12) << name;
+    }
+
+    os << std::endl;
+
+    os << std::left << std::setw(10) << count << std::right;
+    os << std::setw(10) << errors;
+    os << std::setw(12) << (count == 0ul ? 0ul : total / count);
+    os << std::setw(12) << percentile(50ul);
+    os << std::setw(12) << percentile(90ul);
+    os << std::setw(12) << percentile(99ul);
+    os << std::setw(12) << (count == 0ul ? 0ul : latencies.back()) << std::endl;
+  }
+
+private:
+  std::mutex mutex;
+  std::map<Vortex::Uint64, std::string> ready;
+  Vortex::Uint64 next = 0ul;
+  Vortex::Uint64 errors = 0ul;
+  std::vector<Vortex::Uint64> latencies;
+};
+
+std::string ErrorResponse(const std::string& message) {
+  std::string response = "{\"error\":";
+  Vortex::EncodeJson(response, Vortex::Value(new Vortex::String(message.begin(), message.end())));
+  response.push_back('}');
+
+  return response;
+}
+
+// Returns the JSON response to one request. Errors are reported to the
+// client as {"error": "..."} rather than ending the server. That includes
+// exceptions from outside the VM such as std::bad_alloc, since a worker
+// that stopped would hold back every later response.
+std::string respond(
+  Vortex::Machine& worker,
+  const Vortex::Value& program,
+  const std::string& line,
+  bool& error
+) {
+  error = true;
+
+  try {
+    worker.push(Vortex::ParseJson(line.data(), line.data() + line.size()));
+    Vortex::Value result = worker.eval(*program.data.FUNC);
+
+    std::string response;
+    Vortex::EncodeJson(response, result);
+
+    error = false;
+    return response;
+  } catch (const Vortex::Error& e) {
+    std::ostringstream oss;
+    oss << e;
+    return ErrorResponse(oss.str());
+  } catch (const std::exception& e) {
+    return ErrorResponse(e.what());
+  } catch (...) {
+    return ErrorResponse("Unknown exception");
+  }
+}
+
+// Loads a program once and then serves requests from stdin until it
+// closes. Each request is a line of JSON, which the program is called
+// with, and each response is the program's result as a line of JSON, in
+// request order. Requests are spread over --threads worker machines that
+// share the loaded program. Latency statistics go to stderr at the end.
+int serve(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: vxvm serve <program.vx>" << std::endl;
+    return 1;
+  }
+
+  auto codeBlock = FileCodeBlock(argv[1]);
+  auto machine = Vortex::Machine();
+  Vortex::Value program = machine.eval(codeBlock);
+
+  if (program.type != Vortex::FUNC) {
+    std::cerr << "Function expected from initial eval" << std::endl;
+    return 1;
+  }
+
+  auto queue = RequestQueue();
+  auto writer = ResponseWriter();
+
+  auto work = [&]() {
+    auto worker = machine.fork();
+    ServeRequest request;
+
+    while (queue.pop(request)) {
+      bool error = false;
+      auto response = respond(worker, program, request.line, error);
+
+      if (error) {
+        // The stack is left as it was when the request failed
+        worker = machine.fork();
+      }
+
+      writer.complete(request, std::move(response), error);
+    }
+  };
+
+  std::vector<std::future<void>> workers;
+
+  for (auto i = 0ul; i != Vortex::ThreadCount(); ++i) {
+    workers.push_back(std::async(std::launch::async, work));
+  }
+
+  std::string line;
+  Vortex::Uint64 seq = 0ul;
+
+  while (std::getline(std::cin, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+
+    queue.push(ServeRequest{
+      .seq = seq++,
+      .line = std::move(line),
+      .received = Clock::now(),
+    });
+  }
+
+  queue.close();
+
+  for (auto& w: workers) {
+    w.get();
+  }
+
+  writer.printStats(std::cerr);
+
+  return 0;
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+int serve(int argc, char** argv);
@@ -0,0 +1,106 @@
+#include <cerrno>
+#include <iostream>
+
+#include <unistd.h>
+
+#include "stream.hpp"
+
+#include "Array.hpp"
+#include "frontendUtil.hpp"
+#include "Machine.hpp"
+
+// Reads stdin until at least one line is complete, so the program isn't
+// called with nothing. Returns null once everything has been returned.
+Vortex::Value NextLines(LineSplitter& splitter, bool& eof) {
+  char buf[1 << 16];
+
+  while (!eof) {
+    auto len = read(STDIN_FILENO, buf, sizeof(buf));
+
+    if (len < 0 && errno == EINTR) {
+      continue;
+    }
+
+    // Read errors end the input, as they do for LinesFromStream
+    if (len <= 0) {
+      eof = true;
+      auto lines = splitter.finish();
+
+      if (lines.data.ARRAY->Length() != 0ul) {
+        return lines;
+      }
+
+      break;
+    }
+
+    splitter.add(buf, buf + len);
+    auto lines = splitter.take();
+
+    if (lines.data.ARRAY->Length() != 0ul) {
+      return lines;
+    }
+  }
+
+  return Vortex::Value(Vortex::Value::null());
+}
+
+// Runs a program over stdin a chunk of lines at a time, so input of any
+// length can be filtered with bounded memory and output appears as it's
+// produced.
+//
+// Like readfs, the program is called as program(state, lines) and returns
+// [state, output]. The state starts as null. lines holds the lines
+// completed by one read of stdin, or is null once stdin is exhausted, which
+// is the last call. output is an array printed one item per line.
+int stream(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: vxvm stream <program.vx>" << std::endl;
+    return 1;
+  }
+
+  auto codeBlock = FileCodeBlock(argv[1]);
+  auto machine = Vortex::Machine();
+  Vortex::Value program = machine.eval(codeBlock);
+
+  if (program.type != Vortex::FUNC) {
+    std::cerr << "Function expected from initial eval" << std::endl;
+    return 1;
+  }
+
+  auto splitter = LineSplitter();
+  auto state = Vortex::Value(Vortex::Value::null());
+  bool eof = false;
+
+  while (true) {
+    auto lines = NextLines(splitter, eof);
+    bool last = lines.type == Vortex::NULL_;
+
+    machine.push(std::move(lines));
+    machine.push(std::move(state));
+
+    auto result = machine.eval(*program.data.FUNC);
+
+    if (
+      result.type != Vortex::ARRAY ||
+      result.data.ARRAY->Length() != 2ul
+    ) {
+      std::cerr << "Pair expected from program output" << std::endl;
+      return 1;
+    }
+
+    auto output = result.data.ARRAY->extract(1);
+
+    if (output.type != Vortex::ARRAY) {
+      std::cerr << "Expected output to be an array" << std::endl;
+      return 1;
+    }
+
+    vxPrint(output);
+
+    if (last) {
+      return 0;
+    }
+
+    state = result.data.ARRAY->extract(0);
+  }
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+int stream(int argc, char** argv);
@@ -0,0 +1,298 @@
+/*
+ * Checks the libvortexvm C API (vortexvm.h). Built as vortexvm-api-test
+ * and run by ctest. Prints each failed check and exits with 1 if any
+ * failed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "vortexvm.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+  if (!(cond)) { \
+    fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+    failures++; \
+  } \
+} while (0)
+
+static int jsonIs(const vx_value* value, const char* expected) {
+  size_t len = 0;
+  char* text = vx_to_json(value, &len);
+
+  if (text == NULL) {
+    return 0;
+  }
+
+  int res = len == strlen(expected) && memcmp(text, expected, len) == 0;
+  vx_buffer_free(text);
+
+  return res;
+}
+
+static void testCalls(void) {
+  /* (a, b) => a:Length() + b:Length() */
+  const char* src =
+    "func {\n"
+    "  'Length' methodLookup call\n"
+    "  swap 'Length' methodLookup call\n"
+    "  +\n"
+    "} return\n";
+
+  vx_machine* m = vx_machine_new();
+  vx_value* fn = vx_load_program(m, src, strlen(src));
+  CHECK(fn != NULL);
+  CHECK(vx_kind_of(fn) == VX_FUNC);
+
+  vx_value* str = vx_string("h\xc3\xa9llo", 6);
+  vx_value* arr = vx_array_new();
+  CHECK(vx_array_push(arr, str));
+  CHECK(vx_array_push(arr, str));
+
+  const vx_value* args[] = {str, arr};
+  vx_value* res = vx_call(m, fn, args, 2);
+  uint64_t n = 0;
+  CHECK(res != NULL && vx_get_uint64(res, &n) && n == 7);
+
+  /* A failed call reports through vx_last_error and leaves m usable */
+  const vx_value* badArgs[] = {fn, fn};
+  CHECK(vx_call(m, fn, badArgs, 2) == NULL);
+  CHECK(strlen(vx_last_error()) > 0);
+
+  vx_value* again = vx_call(m, fn, args, 2);
+  CHECK(again != NULL && vx_get_uint64(again, &n) && n == 7);
+
+  /* Forks share the loaded program */
+  vx_machine* fork = vx_machine_fork(m);
+  vx_value* forked = vx_call(fork, fn, args, 2);
+  CHECK(forked != NULL && vx_get_uint64(forked, &n) && n == 7);
+
+  CHECK(vx_load_program(m, "bogus", 5) == NULL);
+  CHECK(strlen(vx_last_error()) > 0);
+
+  vx_value_free(forked);
+  vx_value_free(again);
+  vx_value_free(res);
+  vx_value_free(arr);
+  vx_value_free(str);
+  vx_value_free(fn);
+  vx_machine_free(fork);
+  vx_machine_free(m);
+}
+
+/* Copies the error from calling src's function with arr into buf, or ""
+   if it succeeded, since vx_last_error is overwritten by the next call */
+static void callError(
+  vx_machine* m,
+  const char* src,
+  const vx_value* arr,
+  char* buf,
+  size_t size
+) {
+  vx_value* fn = vx_load_program(m, src, strlen(src));
+  const vx_value* args[] = {arr};
+  vx_value* res = vx_call(m, fn, args, 1);
+
+  snprintf(buf, size, "%s", res == NULL ? vx_last_error() : "");
+
+  vx_value_free(res);
+  vx_value_free(fn);
+}
+
+/* 0, 1, ..., bad - 1, then 1i32 at bad and strings up to len, which can be
+   past ParallelArraySize. Reducing with + or mapping with dup + 1u64 +
+   fails first at bad, with a different error than the strings give, so
+   reporting a later chunk's error would be caught. */
+static vx_value* rangeThatFails(uint64_t len, uint64_t bad) {
+  vx_value* arr = vx_array_new();
+
+  for (uint64_t i = 0; i != len; i++) {
+    vx_value* item = (
+      i < bad ? vx_uint64(i) :
+      i == bad ? vx_int32(1) :
+      vx_string("x", 1)
+    );
+
+    vx_array_push(arr, item);
+    vx_value_free(item);
+  }
+
+  return arr;
+}
+
+static void testParallelErrors(void) {
+  vx_machine* m = vx_machine_new();
+  char expected[256];
+  char actual[256];
+
+  /* :reduceAssoc fails with the error :reduce gives, on both paths */
+  uint64_t lens[] = {10, 5000};
+
+  for (size_t i = 0; i != sizeof(lens) / sizeof(lens[0]); i++) {
+    vx_value* arr = rangeThatFails(lens[i], lens[i] * 3 / 5);
+
+    callError(
+      m,
+      "func { func { + } swap 'reduce' methodLookup call } return\n",
+      arr,
+      expected,
+      sizeof(expected)
+    );
+
+    callError(
+      m,
+      "func { func { + } swap 'reduceAssoc' methodLookup call } return\n",
+      arr,
+      actual,
+      sizeof(actual)
+    );
+
+    CHECK(strlen(expected) > 0);
+    CHECK(strcmp(actual, expected) == 0);
+
+    vx_value_free(arr);
+  }
+
+  /* A :map that throws partway through fails the same way on both paths */
+  char sequential[256];
+
+  for (size_t i = 0; i != sizeof(lens) / sizeof(lens[0]); i++) {
+    vx_value* arr = rangeThatFails(lens[i], lens[i] * 3 / 5);
+
+    callError(
+      m,
+      "func { func { dup + 1u64 + } swap 'map' methodLookup call } return\n",
+      arr,
+      i == 0 ? sequential : actual,
+      sizeof(actual)
+    );
+
+    CHECK(strlen(sequential) > 0);
+    CHECK(i == 0 || strcmp(actual, sequential) == 0);
+
+    vx_value_free(arr);
+  }
+
+  vx_machine_free(m);
+}
+
+/* Writes the binary encoding of null inside depth arrays of one element
+   to buf and returns its length */
+static size_t nestedArrays(char* buf, size_t depth) {
+  memcpy(buf, "vxb\x01", 4);
+
+  for (size_t d = 0; d != depth; d++) {
+    buf[4 + 2 * d] = 14; /* BinaryTag::ARRAY */
+    buf[5 + 2 * d] = 1;
+  }
+
+  buf[4 + 2 * depth] = 0; /* BinaryTag::NULL_ */
+
+  return 4 + 2 * depth + 1;
+}
+
+static void testValues(void) {
+  const char* json = "{\"k\": [1, \"x\"], \"n\": null}";
+  vx_value* obj = vx_parse_json(json, strlen(json));
+  CHECK(obj != NULL && vx_kind_of(obj) == VX_OBJECT);
+  CHECK(vx_length(obj) == 2);
+
+  vx_value* k = vx_object_get(obj, "k", 1);
+  CHECK(k != NULL && jsonIs(k, "[1,\"x\"]"));
+
+  CHECK(vx_object_get(obj, "missing", 7) == NULL);
+  CHECK(strcmp(vx_last_error(), "") == 0);
+
+  vx_value* key = vx_object_key_at(obj, 1);
+  char buf[4];
+  CHECK(key != NULL && vx_string_copy(key, buf, sizeof(buf)) == 1);
+  CHECK(buf[0] == 'n');
+
+  CHECK(vx_parse_json("[1,", 3) == NULL);
+  CHECK(strlen(vx_last_error()) > 0);
+
+  /* Binary round trip */
+  size_t len = 0;
+  char* bytes = vx_to_binary(obj, &len);
+  CHECK(bytes != NULL);
+
+  vx_value* decoded = vx_decode_binary(bytes, len);
+  CHECK(decoded != NULL && jsonIs(decoded, "{\"k\":[1,\"x\"],\"n\":null}"));
+
+  /* Packed arrays of numbers round trip too */
+  vx_value* nums = vx_parse_json("[1.5,2,-3]", 10);
+  char* numBytes = vx_to_binary(nums, &len);
+  vx_value* numsDecoded = vx_decode_binary(numBytes, len);
+  CHECK(numsDecoded != NULL && jsonIs(numsDecoded, "[1.5,2,-3]"));
+
+  /* Nesting is limited, like JSON's, instead of overflowing the stack */
+  char nested[4 + 2 * 1000 + 1];
+
+  vx_value* shallow = vx_decode_binary(nested, nestedArrays(nested, 100));
+  CHECK(shallow != NULL && vx_kind_of(shallow) == VX_ARRAY);
+
+  CHECK(vx_decode_binary(nested, nestedArrays(nested, 1000)) == NULL);
+  CHECK(strstr(vx_last_error(), "nested too deeply") != NULL);
+
+  int64_t i = 0;
+  vx_value* big = vx_uint64(UINT64_MAX);
+  CHECK(!vx_get_int64(big, &i));
+
+  vx_value_free(big);
+  vx_value_free(shallow);
+  vx_value_free(numsDecoded);
+  vx_buffer_free(numBytes);
+  vx_value_free(nums);
+  vx_value_free(decoded);
+  vx_buffer_free(bytes);
+  vx_value_free(key);
+  vx_value_free(k);
+  vx_value_free(obj);
+}
+
+int main(void) {
+  CHECK(vx_api_version() == VX_API_VERSION);
+
+  /* Library machines must not write to the host's stderr, so it's
+     captured while the API runs and checked to be empty */
+  fflush(stderr);
+  int savedStderr = dup(2);
+  FILE* captured = tmpfile();
+  dup2(fileno(captured), 2);
+
+  testCalls();
+  testValues();
+  testParallelErrors();
+
+  fflush(stderr);
+  off_t written = lseek(fileno(captured), 0, SEEK_CUR);
+  dup2(savedStderr, 2);
+
+  if (written != 0) {
+    /* Includes failed checks, which are printed here */
+    fprintf(stderr, "stderr was written to while the API ran:\n");
+    lseek(fileno(captured), 0, SEEK_SET);
+
+    char buf[4096];
+    ssize_t n;
+
+    while ((n = read(fileno(captured), buf, sizeof(buf))) > 0) {
+      fwrite(buf, 1, n, stderr);
+    }
+
+    failures++;
+  }
+
+  fclose(captured);
+
+  if (failures != 0) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+
+  printf("vortexvm-api: ok\n");
+  return 0;
+}
@@ -22,5 +22,5 @@ namespace Vortex {
   struct Value;
   using BoxedValue = immer::box<Value>;
 
-  using String = immer::flex_vector<char>;
+  struct String;
 }
@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <immer/algorithm.hpp>
+
+#include "vortexvm.h"
+
+#include "Array.hpp"
+#include "assemble.hpp"
+#include "Binary.hpp"
+#include "Json.hpp"
+#include "Machine.hpp"
+#include "Object.hpp"
+#include "Set.hpp"
+
+struct vx_machine {
+  Vortex::Machine machine;
+};
+
+struct vx_value {
+  Vortex::Value value;
+};
+
+namespace {
+  thread_local std::string lastError;
+
+  void SetError(const std::string& message) {
+    lastError = message;
+  }
+
+  vx_value* Wrap(Vortex::Value value) {
+    return new vx_value{std::move(value)};
+  }
+
+  // Runs f, turning anything it throws into the thread's last error, so
+  // exceptions never cross into C. Returns fallback if f throws.
+  template <typename F, typename T>
+  T Guard(F f, T fallback) {
+    try {
+      return f();
+    } catch (const Vortex::Error& e) {
+      std::ostringstream oss;
+      oss << e;
+      SetError(oss.str());
+    } catch (const std::exception& e) {
+      SetError(e.what());
+    } catch (...) {
+      SetError("Unknown error");
+    }
+
+    return fallback;
+  }
+
+  char* CopyBuffer(const std::string& bytes, size_t* len) {
+    auto buffer = static_cast<char*>(std::malloc(bytes.size() + 1ul));
+
+    if (buffer == nullptr) {
+      throw std::bad_alloc();
+    }
+
+    std::memcpy(buffer, bytes.data(), bytes.size());
+    buffer[bytes.size()] = '\0';
+
+    if (len != nullptr) {
+      *len = bytes.size();
+    }
+
+    return buffer;
+  }
+
+  const Vortex::Array& ExpectArray(const vx_value* arr) {
+    if (arr->value.type != Vortex::ARRAY) {
+      throw Vortex::TypeError("Expected an array");
+    }
+
+    return *arr->value.data.ARRAY;
+  }
+
+  const Vortex::Object& ExpectObject(const vx_value* obj) {
+    if (obj->value.type != Vortex::OBJECT) {
+      throw Vortex::TypeError("Expected an object");
+    }
+
+    return *obj->value.data.OBJECT;
+  }
+
+  bool IsInteger(Vortex::Code type) {
+    return type >= Vortex::UINT8 && type <= Vortex::INT64;
+  }
+
+  bool IsSigned(Vortex::Code type) {
+    return type >= Vortex::INT8 && type <= Vortex::INT64;
+  }
+
+  Vortex::Int64 SignedValue(const Vortex::Value& value) {
+    switch (value.type) {
+      case Vortex::INT8: return value.data.INT8;
+      case Vortex::INT16: return value.data.INT16;
+      case Vortex::INT32: return value.data.INT32;
+      case Vortex::INT64: return value.data.INT64;
+
+      default:
+        throw Vortex::InternalError("Not a signed integer");
+    }
+  }
+
+  Vortex::Uint64 UnsignedValue(const Vortex::Value& value) {
+    switch (value.type) {
+      case Vortex::UINT8: return value.data.UINT8;
+      case Vortex::UINT16: return value.data.UINT16;
+      case Vortex::UINT32: return value.data.UINT32;
+      case Vortex::UINT64: return value.data.UINT64;
+
+      default:
+        throw Vortex::InternalError("Not an unsigned integer");
+    }
+  }
+}
+
+extern "C" {
+  int vx_api_version(void) {
+    return VX_API_VERSION;
+  }
+
+  const char* vx_last_error(void) {
+    return lastError.c_str();
+  }
+
+  vx_machine* vx_machine_new(void) {
+    return Guard([]() {
+      auto res = new vx_machine();
+
+      // Errors are only reported through vx_last_error
+      res->machine.reportErrors = false;
+
+      return res;
+    }, (vx_machine*)nullptr);
+  }
+
+  vx_machine* vx_machine_fork(const vx_machine* machine) {
+    return Guard(
+      [&]() { return new vx_machine{machine->machine.fork()}; },
+      (vx_machine*)nullptr
+    );
+  }
+
+  void vx_machine_free(vx_machine* machine) {
+    delete machine;
+  }
+
+  vx_value* vx_load_program(vx_machine* machine, const char* source, size_t len) {
+    return Guard([&]() {
+      auto in = std::istringstream(std::string(source, len));
+      auto out = std::ostringstream();
+      Vortex::assemble(in, out);
+      std::string bytes = out.str();
+
+      auto code = Vortex::Func{
+        .def = decltype(Vortex::Func().def)(bytes.begin(), bytes.end())
+      };
+
+      try {
+        return Wrap(machine->machine.eval(std::move(code)));
+      } catch (...) {
+        // Leave the machine usable after a failed evaluation
+        machine->machine.calc.clear();
+        machine->machine.cc.clear();
+        throw;
+      }
+    }, (vx_value*)nullptr);
+  }
+
+  vx_value* vx_call(
+    vx_machine* machine,
+    const vx_value* fn,
+    const vx_value* const* args,
+    size_t argc
+  ) {
+    return Guard([&]() {
+      if (fn->value.type != Vortex::FUNC) {
+        throw Vortex::TypeError("Expected a function");
+      }
+
+      auto& m = machine->machine;
+
+      try {
+        // The first argument goes on top of the stack
+        for (auto i = argc; i != 0ul; --i) {
+          m.push(args[i - 1ul]->value);
+        }
+
+        return Wrap(m.eval(*fn->value.data.FUNC));
+      } catch (...) {
+        m.calc.clear();
+        m.cc.clear();
+        throw;
+      }
+    }, (vx_value*)nullptr);
+  }
+
+  vx_value* vx_null(void) {
+    return Wrap(Vortex::Value(Vortex::Value::null()));
+  }
+
+  vx_value* vx_bool(int value) {
+    return Wrap(Vortex::Value(value != 0));
+  }
+
+  vx_value* vx_int32(int32_t value) {
+    return Wrap(Vortex::Value(Vortex::Int32(value)));
+  }
+
+  vx_value* vx_int64(int64_t value) {
+    return Wrap(Vortex::Value(Vortex::Int64(value)));
+  }
+
+  vx_value* vx_uint64(uint64_t value) {
+    return Wrap(Vortex::Value(Vortex::Uint64(value)));
+  }
+
+  vx_value* vx_float64(double value) {
+    return Wrap(Vortex::Value(Vortex::Float64(value)));
+  }
+
+  vx_value* vx_string(const char* str, size_t len) {
+    return Guard(
+      [&]() { return Wrap(Vortex::Value(new Vortex::String(str, str + len))); },
+      (vx_value*)nullptr
+    );
+  }
+
+  vx_value* vx_array_new(void) {
+    return Wrap(Vortex::Value(new Vortex::Array()));
+  }
+
+  int vx_array_push(vx_value* arr, const vx_value* item) {
+    return Guard([&]() {
+      ExpectArray(arr);
+      arr->value.data.ARRAY->pushBack(Vortex::Value(item->value));
+      return 1;
+    }, 0);
+  }
+
+  vx_value* vx_object_new(void) {
+    return Wrap(Vortex::Value(new Vortex::Object()));
+  }
+
+  int vx_object_insert(vx_value* obj, const char* key, size_t len, const vx_value* value) {
+    return Guard([&]() {
+      ExpectObject(obj);
+
+      obj->value.data.OBJECT->insert(
+        Vortex::Value(new Vortex::String(key, key + len)),
+        value->value
+      );
+
+      return 1;
+    }, 0);
+  }
+
+  vx_value* vx_parse_json(const char* text, size_t len) {
+    return Guard(
+      [&]() { return Wrap(Vortex::ParseJson(text, text + len)); },
+      (vx_value*)nullptr
+    );
+  }
+
+  vx_value* vx_decode_binary(const char* bytes, size_t len) {
+    return Guard(
+      [&]() { return Wrap(Vortex::DecodeBinary(bytes, bytes + len)); },
+      (vx_value*)nullptr
+    );
+  }
+
+  vx_value* vx_value_copy(const vx_value* value) {
+    return Guard([&]() { return Wrap(value->value); }, (vx_value*)nullptr);
+  }
+
+  void vx_value_free(vx_value* value) {
+    delete value;
+  }
+
+  vx_kind vx_kind_of(const vx_value* value) {
+    switch (value->value.type) {
+      case Vortex::NULL_: return VX_NULL;
+      case Vortex::BOOL: return VX_BOOL;
+      case Vortex::UINT8: return VX_UINT8;
+      case Vortex::UINT16: return VX_UINT16;
+      case Vortex::UINT32: return VX_UINT32;
+      case Vortex::UINT64: return VX_UINT64;
+      case Vortex::INT8: return VX_INT8;
+      case Vortex::INT16: return VX_INT16;
+      case Vortex::INT32: return VX_INT32;
+      case Vortex::INT64: return VX_INT64;
+      case Vortex::FLOAT32: return VX_FLOAT32;
+      case Vortex::FLOAT64: return VX_FLOAT64;
+      case Vortex::STRING: return VX_STRING;
+      case Vortex::ARRAY: return VX_ARRAY;
+      case Vortex::VSET: return VX_SET;
+      case Vortex::OBJECT: return VX_OBJECT;
+      default: return VX_FUNC;
+    }
+  }
+
+  int vx_get_bool(const vx_value* value, int* out) {
+    if (value->value.type != Vortex::BOOL) {
+      SetError("Expected a bool");
+      return 0;
+    }
+
+    *out = value->value.data.BOOL ? 1 : 0;
+    return 1;
+  }
+
+  int vx_get_int64(const vx_value* value, int64_t* out) {
+    const auto& v = value->value;
+
+    if (!IsInteger(v.type)) {
+      SetError("Expected an integer");
+      return 0;
+    }
+
+    if (IsSigned(v.type)) {
+      *out = SignedValue(v);
+      return 1;
+    }
+
+    auto u = UnsignedValue(v);
+
+    if (u > Vortex::Uint64(std::numeric_limits<int64_t>::max())) {
+      SetError("Integer out of range");
+      return 0;
+    }
+
+    *out = int64_t(u);
+    return 1;
+  }
+
+  int vx_get_uint64(const vx_value* value, uint64_t* out) {
+    const auto& v = value->value;
+
+    if (!IsInteger(v.type)) {
+      SetError("Expected an integer");
+      return 0;
+    }
+
+    if (!IsSigned(v.type)) {
+      *out = UnsignedValue(v);
+      return 1;
+    }
+
+    auto i = SignedValue(v);
+
+    if (i < 0) {
+      SetError("Integer out of range");
+      return 0;
+    }
+
+    *out = uint64_t(i);
+    return 1;
+  }
+
+  int vx_get_float64(const vx_value* value, double* out) {
+    switch (value->value.type) {
+      case Vortex::FLOAT32: *out = value->value.data.FLOAT32; return 1;
+      case Vortex::FLOAT64: *out = value->value.data.FLOAT64; return 1;
+
+      default:
+        SetError("Expected a float");
+        return 0;
+    }
+  }
+
+  size_t vx_string_copy(const vx_value* value, char* buf, size_t cap) {
+    if (value->value.type != Vortex::STRING) {
+      SetError("Expected a string");
+      return 0;
+    }
+
+    const auto& str = *value->value.data.STRING;
+    size_t pos = 0ul;
+
+    immer::for_each_chunk(str, [&](const char* first, const char* last) {
+      size_t len = last - first;
+
+      if (pos < cap) {
+        std::memcpy(buf + pos, first, std::min(len, cap - pos));
+      }
+
+      pos += len;
+    });
+
+    return str.size();
+  }
+
+  size_t vx_length(const vx_value* value) {
+    switch (value->value.type) {
+      case Vortex::ARRAY: return value->value.data.ARRAY->Length();
+      case Vortex::VSET: return value->value.data.SET->values.size();
+      case Vortex::OBJECT: return value->value.data.OBJECT->keys.Length();
+
+      default:
+        SetError("Expected an array, set or object");
+        return 0;
+    }
+  }
+
+  vx_value* vx_array_at(const vx_value* arr, size_t i) {
+    return Guard(
+      [&]() { return Wrap(ExpectArray(arr).at(i)); },
+      (vx_value*)nullptr
+    );
+  }
+
+  vx_value* vx_object_get(const vx_value* obj, const char* key, size_t len) {
+    return Guard([&]() {
+      const auto& object = ExpectObject(obj);
+      auto pos = object.indexOf(Vortex::Value(new Vortex::String(key, key + len)));
+
+      if (pos == object.keys.Length()) {
+        SetError("");
+        return (vx_value*)nullptr;
+      }
+
+      return Wrap(object.values.at(pos));
+    }, (vx_value*)nullptr);
+  }
+
+  vx_value* vx_object_key_at(const vx_value* obj, size_t i) {
+    return Guard(
+      [&]() { return Wrap(ExpectObject(obj).keys.at(i)); },
+      (vx_value*)nullptr
+    );
+  }
+
+  vx_value* vx_object_value_at(const vx_value* obj, size_t i) {
+    return Guard(
+      [&]() { return Wrap(ExpectObject(obj).values.at(i)); },
+      (vx_value*)nullptr
+    );
+  }
+
+  char* vx_to_json(const vx_value* value, size_t* len) {
+    return Guard([&]() {
+      std::string text;
+      Vortex::EncodeJson(text, value->value);
+      return CopyBuffer(text, len);
+    }, (char*)nullptr);
+  }
+
+  char* vx_to_binary(const vx_value* value, size_t* len) {
+    return Guard([&]() {
+      std::string bytes;
+      Vortex::EncodeBinary(bytes, value->value);
+      return CopyBuffer(bytes, len);
+    }, (char*)nullptr);
+  }
+
+  void vx_buffer_free(char* buffer) {
+    std::free(buffer);
+  }
+}
@@ -0,0 +1,149 @@
+#ifndef VORTEXVM_H
+#define VORTEXVM_H
+
+/*
+ * C API for embedding the Vortex VM (libvortexvm).
+ *
+ * Values and machines are opaque handles owned by the caller and released
+ * with vx_value_free and vx_machine_free. Functions never take ownership
+ * of the values passed to them: values are immutable and copying one
+ * shares its contents, so passing a large value costs the same as passing
+ * a small one.
+ *
+ * Functions that can fail return NULL (or 0 where noted) and set a
+ * message that vx_last_error returns on the same thread. Errors are
+ * never written to stderr.
+ *
+ * A machine must only be used by one thread at a time. To evaluate on
+ * several threads, load a program once and give each thread a
+ * vx_machine_fork of that machine, which shares the loaded code and
+ * module values.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VX_API_VERSION 1
+
+typedef struct vx_machine vx_machine;
+typedef struct vx_value vx_value;
+
+typedef enum vx_kind {
+  VX_NULL,
+  VX_BOOL,
+  VX_UINT8,
+  VX_UINT16,
+  VX_UINT32,
+  VX_UINT64,
+  VX_INT8,
+  VX_INT16,
+  VX_INT32,
+  VX_INT64,
+  VX_FLOAT32,
+  VX_FLOAT64,
+  VX_STRING,
+  VX_ARRAY,
+  VX_SET,
+  VX_OBJECT,
+  VX_FUNC,
+} vx_kind;
+
+/* Returns VX_API_VERSION of the library that was linked */
+int vx_api_version(void);
+
+/* The last error on this thread, or an empty string */
+const char* vx_last_error(void);
+
+/* Machines */
+
+vx_machine* vx_machine_new(void);
+vx_machine* vx_machine_fork(const vx_machine* machine);
+void vx_machine_free(vx_machine* machine);
+
+/*
+ * Assembles and evaluates program text (the vxvm assembly that vxvm eval
+ * and vxvm lines accept) and returns its value, which for vxvm lines style
+ * programs is the function to call.
+ */
+vx_value* vx_load_program(vx_machine* machine, const char* source, size_t len);
+
+/* Calls fn with argc arguments, args[0] being the first */
+vx_value* vx_call(
+  vx_machine* machine,
+  const vx_value* fn,
+  const vx_value* const* args,
+  size_t argc
+);
+
+/* Constructing values */
+
+vx_value* vx_null(void);
+vx_value* vx_bool(int value);
+vx_value* vx_int32(int32_t value);
+vx_value* vx_int64(int64_t value);
+vx_value* vx_uint64(uint64_t value);
+vx_value* vx_float64(double value);
+
+/* str need not be null terminated and should be UTF-8 */
+vx_value* vx_string(const char* str, size_t len);
+
+vx_value* vx_array_new(void);
+
+/* Appends a copy of item. Returns 0 if arr isn't an array. */
+int vx_array_push(vx_value* arr, const vx_value* item);
+
+vx_value* vx_object_new(void);
+
+/* Inserts a copy of value. Returns 0 if obj isn't an object or already
+   has the key. */
+int vx_object_insert(vx_value* obj, const char* key, size_t len, const vx_value* value);
+
+vx_value* vx_parse_json(const char* text, size_t len);
+vx_value* vx_decode_binary(const char* bytes, size_t len);
+
+vx_value* vx_value_copy(const vx_value* value);
+void vx_value_free(vx_value* value);
+
+/* Inspecting values */
+
+vx_kind vx_kind_of(const vx_value* value);
+
+/* Return 0 and set an error if the value isn't of a matching kind. The
+   integer getters accept any integer kind that fits. */
+int vx_get_bool(const vx_value* value, int* out);
+int vx_get_int64(const vx_value* value, int64_t* out);
+int vx_get_uint64(const vx_value* value, uint64_t* out);
+int vx_get_float64(const vx_value* value, double* out);
+
+/*
+ * Copies up to cap bytes of a string's UTF-8 into buf and returns the
+ * string's full length in bytes, so a call with cap 0 measures it.
+ * Returns 0 and sets an error for non-strings.
+ */
+size_t vx_string_copy(const vx_value* value, char* buf, size_t cap);
+
+/* Number of elements in an array or set, or entries in an object */
+size_t vx_length(const vx_value* value);
+
+vx_value* vx_array_at(const vx_value* arr, size_t i);
+
+/* NULL with an empty vx_last_error if obj has no such key */
+vx_value* vx_object_get(const vx_value* obj, const char* key, size_t len);
+
+vx_value* vx_object_key_at(const vx_value* obj, size_t i);
+vx_value* vx_object_value_at(const vx_value* obj, size_t i);
+
+/* Serialized forms, released with vx_buffer_free */
+char* vx_to_json(const vx_value* value, size_t* len);
+char* vx_to_binary(const vx_value* value, size_t* len);
+void vx_buffer_free(char* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
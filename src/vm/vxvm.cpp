@@ -1,22 +1,94 @@
 #include <iostream>
+#include <iterator>
+
+#include <poll.h>
+#include <unistd.h>
 
 #include <immer/flex_vector_transient.hpp>
 
 #include "assemble.hpp"
+#include "Binary.hpp"
 #include "Decoder.hpp"
 #include "frontendUtil.hpp"
+#include "HeapStats.hpp"
+#include "Json.hpp"
 #include "Machine.hpp"
+#include "Memo.hpp"
+#include "Modules.hpp"
+#include "Parallel.hpp"
 #include "readfs.hpp"
+#include "serve.hpp"
+#include "stream.hpp"
 
 int usage();
+int runProgram(int argc, char** argv);
 
 int eval();
 int lines(int argc, char** argv);
 int asm_();
 int dasm();
 int args_(int argc, char** argv);
+int binary();
+int json(int argc, char** argv);
 
 int main(int argc, char** argv) {
+  bool heapStats = false;
+
+  // Options for the VM itself come before the subcommand
+  while (argc >= 2 && std::string(argv[1]).rfind("--", 0) == 0) {
+    std::string option(argv[1]);
+
+    if (option == "--heap-stats") {
+      heapStats = true;
+    } else if (option == "--memo-size" && argc >= 3) {
+      try {
+        Vortex::SetMemoSize(std::stoul(argv[2]));
+      } catch (const std::exception&) {
+        return usage();
+      }
+
+      argc--;
+      argv++;
+    } else if (option == "--eager-modules") {
+      Vortex::SetEagerModules(true);
+    } else if (option == "--threads" && argc >= 3) {
+      try {
+        Vortex::SetThreadCount(std::stoul(argv[2]));
+      } catch (const std::exception&) {
+        return usage();
+      }
+
+      argc--;
+      argv++;
+    } else {
+      return usage();
+    }
+
+    argc--;
+    argv++;
+  }
+
+  int status = runProgram(argc, argv);
+
+  if (heapStats) {
+    Vortex::PrintHeapStats(std::cerr);
+    Vortex::PrintMemoStats(std::cerr);
+  }
+
+  #ifndef NDEBUG
+    // By now the machine and every Value the subcommand created are gone,
+    // so anything still live has leaked.
+    if (Vortex::LivePayloads() != 0) {
+      std::cerr << "Leaked VM payloads:" << std::endl;
+      Vortex::PrintHeapStats(std::cerr);
+      Vortex::Assert(false);
+    }
+  #endif
+
+  return status;
+}
+
+int runProgram(int argc, char** argv) {
   if (argc < 2) {
     return usage();
   }
@@ -29,12 +101,16 @@ int main(int argc, char** argv) {
   if (prog == "dasm") { return dasm(); }
   if (prog == "args") { return args_(argc - 1, argv + 1); }
   if (prog == "readfs") { return readfs(argc - 1, argv + 1); }
+  if (prog == "binary") { return binary(); }
+  if (prog == "json") { return json(argc - 1, argv + 1); }
+  if (prog == "stream") { return stream(argc - 1, argv + 1); }
+  if (prog == "serve") { return serve(argc - 1, argv + 1); }
 
   return usage();
 }
 
 int usage() {
-  std::cerr << "Usage: vxvm [eval|lines|asm|dasm|args|readfs] [...]" << std::endl;
+  std::cerr << "Usage: vxvm [--heap-stats] [--threads <n>] [--eager-modules] [--memo-size <n>] [eval|lines|asm|dasm|args|readfs|binary|json|stream|serve] [...]" << std::endl;
   return 1;
 }
 
@@ -63,7 +139,7 @@ int lines(int argc, char** argv) {
     return 1;
   }
 
-  machine.push(LinesFromStream(std::cin));
+  machine.push(LinesFromStdin());
   Vortex::Value result = machine.eval(*program.data.FUNC);
 
   vxPrint(result);
@@ -106,3 +182,83 @@ int args_(int argc, char** argv) {
 
   return 0;
 }
+
+int binary() {
+  // Decodes a value written by :Binary() and prints it like eval does
+  std::string input(
+    (std::istreambuf_iterator<char>(std::cin)),
+    std::istreambuf_iterator<char>()
+  );
+
+  Vortex::Value value = Vortex::DecodeBinary(
+    input.data(),
+    input.data() + input.size()
+  );
+
+  std::cout << value << std::endl;
+
+  return 0;
+}
+
+// Whether stdin has more input that can be read without blocking
+bool InputReady() {
+  if (std::cin.rdbuf()->in_avail() > 0) {
+    return true;
+  }
+
+  pollfd fd = {STDIN_FILENO, POLLIN, 0};
+  return poll(&fd, 1, 0) == 1;
+}
+
+int json(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: vxvm json <program.vx>" << std::endl;
+    return 1;
+  }
+
+  auto codeBlock = FileCodeBlock(argv[1]);
+  auto machine = Vortex::Machine();
+  Vortex::Value program = machine.eval(codeBlock);
+
+  if (program.type != Vortex::FUNC) {
+    std::cerr << "Function expected from initial eval" << std::endl;
+    return 1;
+  }
+
+  // Newline delimited JSON: the program is called with each record as it
+  // arrives and its result is written as a line of JSON, or dropped if it
+  // is null. Output is batched while more input is ready, so records don't
+  // each cost a write, and flushed before waiting for input so a client
+  // streaming records gets each result straight away.
+  constexpr std::size_t OutputBufferSize = 1ul << 16;
+
+  std::string line;
+  std::string output;
+
+  while (std::getline(std::cin, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+
+    machine.push(Vortex::ParseJson(line.data(), line.data() + line.size()));
+    Vortex::Value result = machine.eval(*program.data.FUNC);
+
+    if (result.type == Vortex::NULL_) {
+      continue;
+    }
+
+    Vortex::EncodeJson(output, result);
+    output.push_back('\n');
+
+    if (output.size() >= OutputBufferSize || !InputReady()) {
+      std::cout.write(output.data(), output.size());
+      std::cout.flush();
+      output.clear();
+    }
+  }
+
+  std::cout.write(output.data(), output.size());
+  std::cout.flush();
+
+  return 0;
+}
@@ -260,7 +260,7 @@ const inputs: { type: 'file', name: string }[] = [];
       lines.push(
         `mfunc $${file} {`,
         ...ByteCoder.Block(
-          ByteCoder(file),
+          ByteCoder(file, Boolean(args.memo)),
           mod.program
         ).map(line => '  ' + line),
         `}`,